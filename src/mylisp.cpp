@@ -14,6 +14,62 @@ LispInterpreter in C++
 #include <vector>
 #include <list>
 #include <map>
+#include <set>
+#include <queue>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <functional>
+#include <cmath>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SIMD_X86
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#define SIMD_X86
+#define TARGET_AVX2
+#define TARGET_SSE2
+#endif
+
+//׸   ȯ. x86-64   § ,   POSIX ucontext Ѵ.
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__linux__)
+#define GREEN_ASM
+#elif !defined(_WIN32)
+#include <ucontext.h>
+#define GREEN_UCONTEXT
+#endif
+#if defined(GREEN_ASM) || defined(GREEN_UCONTEXT)
+#include <sys/mman.h>
+#endif
+#ifndef _WIN32
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <cerrno>
+#endif
+//--serve ̺Ʈ  epoll Ƿ  ȴ.
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#define EPOLL_SERVER
+#endif
 
 
 using namespace std;
@@ -22,13 +78,73 @@ using namespace std;
 //////////////////////////////////////// cell ////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////
 
-enum cell_type { Symbol, Number, List, Proc, String, Lambda };
+enum cell_type { Symbol, Number, List, Proc, String, Lambda, Vector, Hash, OMap, Iterator, Promise, Macro, Future, Task, Channel, Ref };
 //cellο Ե celltype enum . magic number ⺸  ˱ 
 //enum ش.
 
 struct environment; // cell environment ϰ, environment cell ϹǷ
 //ü 漱 ش.
 
+struct gc_heap;
+struct gc_marker;
+//cell  ǹǷ,  cell Բ Ű ؾ ϴ ( )
+//object ӹ޾   cell ͸ ִ´.
+//    heap ö󰡰, 𿡼  ʰ Ǹ   .
+struct object {
+	gc_heap* heap;//0̸  ʴ´.
+	size_t gc_slot;//heap ȣ. ǥ Ʈ  ȣ ã´.
+
+	object();
+	object(const object&) = delete;//heap ȣ ü ϳ̹Ƿ  ʴ´.
+	object& operator=(const object&) = delete;
+	virtual ~object();
+	virtual void trace(gc_marker&) const {}//Ű cell ü ڷ  gc_marker ˸.
+	virtual bool pinned() const { return false; }//true  ʾƵ  ʴ´.
+};
+
+struct cell;
+struct cell_block;
+//cell Ʈ ҵ. cell ϸ  (cell_block) Բ ,
+//Ҹ ٲٷ   ٸ cell Բ   ׶ Ѵ(copy-on-write).
+//׷ cell  Ʈ ̿     ̴.
+//const ϸ  Ƿ, б⸸ ϴ  const cell& ޴´.
+class shared_cells {
+public:
+	typedef vector<cell>::iterator iterator;
+	typedef vector<cell>::const_iterator const_iterator;
+
+	size_t size() const;
+	bool empty() const { return size() == 0; }
+	const_iterator begin() const;
+	const_iterator end() const;
+	const cell& operator[](size_t i) const;
+	const cell& front() const { return (*this)[0]; }
+	const cell& back() const { return (*this)[size() - 1]; }
+	operator const vector<cell>&() const;
+
+	//Ʒ Ҹ ٲ  Ƿ  Ҹ ȥ ´.
+	vector<cell>& mut();
+	iterator begin();
+	iterator end();
+	cell& operator[](size_t i);
+	cell& front() { return (*this)[0]; }
+	cell& back() { return (*this)[size() - 1]; }
+	void push_back(const cell& c);
+	void reserve(size_t n);
+	void resize(size_t n);
+	void clear() { p.reset(); }
+	iterator erase(const_iterator i);
+	template <class It> void insert(const_iterator at, It first, It last);
+	void swap(vector<cell>& v);
+	shared_cells& operator=(const vector<cell>& v);
+
+	const cell_block* block() const { return p.get(); }
+	bool shared() const { return p.use_count() > 1; }
+	void share(const shared_ptr<cell_block>& b) { p = b; }
+private:
+	shared_ptr<cell_block> p;// Ʈ 0
+};
+
 //پ     ִ ü.
 struct cell {
 	typedef cell(*proc_type)(const vector<cell>&);//ν ŸԺ, شϴ ͸ ڷ ϴ Լ ޴ Լ 
@@ -37,223 +153,1876 @@ struct cell {
 
 	cell_type type;//شϴ   .ex)ڴ Number,ɺ̸ Symbol
 	string val;//token data
-	vector<cell> list;//  token vector . ex:(setq x 5)  setq,x,5
+	shared_cells list;//  token vector . ex:(setq x 5)  setq,x,5
 	proc_type proc;
 	environment* env;
+	object* obj;//Vector   ü Ŵ
 
-	cell(cell_type type = Symbol) : type(type), env(0) {}
-	cell(cell_type type, const string& val) : type(type), val(val), env(0) {}
-	cell(proc_type proc) : type(Proc), proc(proc), env(0) {}
+	cell(cell_type type = Symbol) : type(type), proc(0), env(0), obj(0) {}
+	cell(cell_type type, const string& val) : type(type), val(val), proc(0), env(0), obj(0) {}
+	cell(proc_type proc) : type(Proc), proc(proc), env(0), obj(0) {}
 };
 
 typedef vector<cell> cells;
 typedef cells::const_iterator cellit;
 
+struct cell_block {
+	cells items;
+	size_t hash;//ؽ ̵ܽ   ؽ
+	bool interned;//ؽ ̵ܽ Ҹ true.   ϳ Ҹ ´.
+
+	cell_block() : hash(0), interned(false) {}
+	cell_block(const cells& items) : items(items), hash(0), interned(false) {}
+};
+const cells empty_cells;
+inline size_t shared_cells::size() const { return p ? p->items.size() : 0; }
+inline shared_cells::const_iterator shared_cells::begin() const { return p ? p->items.begin() : empty_cells.begin(); }
+inline shared_cells::const_iterator shared_cells::end() const { return p ? p->items.end() : empty_cells.end(); }
+inline const cell& shared_cells::operator[](size_t i) const { return p->items[i]; }
+inline shared_cells::operator const cells&() const { return p ? p->items : empty_cells; }
+inline cells& shared_cells::mut() {
+	if (!p) p = make_shared<cell_block>();
+	else if (p.use_count() > 1) p = make_shared<cell_block>(p->items);
+	else {//ȥ , ٸ 尡 纻     ⼭ ٲٱ    .
+#ifdef __SANITIZE_THREAD__
+		shared_ptr<cell_block> sync(p);//ThreadSanitizer Ÿ 𸣹Ƿ    ٲ㼭 ˸.
+#else
+		atomic_thread_fence(memory_order_acquire);
+#endif
+	}
+	return p->items;
+}
+inline shared_cells::iterator shared_cells::begin() { return mut().begin(); }
+inline shared_cells::iterator shared_cells::end() { return mut().end(); }
+inline cell& shared_cells::operator[](size_t i) { return mut()[i]; }
+inline void shared_cells::push_back(const cell& c) { mut().push_back(c); }
+inline void shared_cells::reserve(size_t n) { mut().reserve(n); }
+inline void shared_cells::resize(size_t n) { mut().resize(n); }
+inline shared_cells::iterator shared_cells::erase(const_iterator i) {
+	size_t at = i - static_cast<const shared_cells&>(*this).begin();//mut() Ҹ ű  Ƿ ġ ȣ ٲд.
+	cells& v = mut();
+	return v.erase(v.begin() + at);
+}
+template <class It> void shared_cells::insert(const_iterator at, It first, It last) {
+	size_t pos = at - static_cast<const shared_cells&>(*this).begin();
+	cells& v = mut();
+	v.insert(v.begin() + pos, first, last);
+}
+inline void shared_cells::swap(cells& v) {
+	p = make_shared<cell_block>();
+	p->items.swap(v);
+}
+inline shared_cells& shared_cells::operator=(const cells& v) {
+	p = make_shared<cell_block>(v);
+	return *this;
+}
+
 const cell false_sym(Symbol, "FALSE");
 const cell true_sym(Symbol, "TRUE"); //false_sym ƴ ͵  true_sym̴.
 const cell nil(Symbol, "NIL");
 const cell error(Symbol, "ERROR");
 
+// . Ҹ ڿ ƴ϶ long long/double ״(unboxed) Ѵ.
+//  ints, Ҽ ϳ ̸ flts Ѵ.
+//2 ĵ  ü Ÿ, Ҵ  켱(row-major) ȴ.
+struct numvec : object {
+	bool is_float;
+	vector<long long> ints;
+	vector<double> flts;
+	size_t rows, cols;//̸ / , 1 ͸ rows == 0
+
+	numvec(bool is_float = false) : is_float(is_float), rows(0), cols(0) {}
+	size_t size() const { return is_float ? flts.size() : ints.size(); }
+	bool is_matrix() const { return rows != 0; }
+	// Ϳ Ҽ  ü double ٲش.
+	void to_float() {
+		if (is_float) return;
+		flts.assign(ints.begin(), ints.end());
+		ints.clear();
+		is_float = true;
+	}
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////// environment ////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////////////////////
 
 
+//Լ ȣ ȯ濡 SETQ   (env_) FUTURE  ٸ 忡 д ȿ þ  Ƿ
+//  env_lock ȣѴ.   slots_  常 Ƿ  ʴ´.
+shared_mutex& env_lock();
+
+//  д 帶 ϳ δ  (hazard pointer).  ϴ   cell ⿡  θ
+//   ʴ´. 尡  ڸ  ٸ 尡 ٽ .
+//  ä(linked_queue) ְ    ִ 带 nodes    Ų.
+struct alignas(64) global_reader {
+	atomic<const cell*> hazard;
+	atomic<const void*> nodes[2];
+	atomic<bool> used;
+	global_reader* next;
+
+	global_reader() : hazard(0), used(true), next(0) {
+		nodes[0].store(0, memory_order_relaxed);
+		nodes[1].store(0, memory_order_relaxed);
+	}
+	static atomic<global_reader*> head;//     ʴ´.
+	static global_reader& mine() {
+		thread_local global_reader* r = 0;// θǷ ʱȭ ˻簡  ͷ  .
+		if (!r) {
+			struct holder {
+				global_reader* r;
+				holder() : r(acquire()) {}
+				~holder() { r->used.store(false, memory_order_release); }
+			};
+			thread_local holder h;
+			r = h.r;
+		}
+		return *r;
+	}
+private:
+	static global_reader* acquire() {
+		for (global_reader* r = head.load(memory_order_acquire); r; r = r->next) {
+			bool expected = false;
+			if (!r->used.load(memory_order_relaxed) && r->used.compare_exchange_strong(expected, true)) return r;
+		}
+		global_reader* r = new global_reader;
+		r->next = head.load(memory_order_relaxed);
+		while (!head.compare_exchange_weak(r->next, r, memory_order_release, memory_order_relaxed)) {}
+		return r;
+	}
+};
+atomic<global_reader*> global_reader::head(0);
+
+// ȯ ǥ. +, CAR  Լ  ⼭ ãǷ д   ʴ´.
+//׸(entry)    űų  ʴ´. ׸  ڸ ٲ ʰ,  cell 
+//ٲ    cell retired_values (RCU). д   Ϳ   ä  ϹǷ,
+//    Ϳ   cell .
+//  write_lock   ϳ ´.  ̸ ׸  ä ڿ  ĭ ְ,
+//ǥ  Ѱ    ũ  index  current ٲ ܴ.
+// index  а ִ 尡   Ƿ retired  ξٰ ǥ Բ .
+struct global_table {
+	struct entry {
+		string name;
+		size_t hash;
+		atomic<cell*> value;
+		entry(const string& name, size_t hash, const cell& v) : name(name), hash(hash), value(new cell(v)) {}
+		~entry() { delete value.load(); }
+	};
+	struct index {
+		size_t mask;
+		vector<atomic<entry*> > slots;
+		explicit index(size_t size) : mask(size - 1), slots(size) {
+			for (size_t i = 0; i < size; i++) slots[i].store(0, memory_order_relaxed);
+		}
+	};
+	enum { RECLAIM_BATCH = 64 };//  ̸ŭ ̸   ִ  .
+
+	global_table() : count(0), taken(0) { current.store(new index(256), memory_order_relaxed); }
+	~global_table() {
+		delete current.load();
+		for (size_t i = 0; i < retired.size(); i++) delete retired[i];
+		for (size_t i = 0; i < entries.size(); i++) delete entries[i];
+		for (size_t i = 0; i < retired_values.size(); i++) delete retired_values[i];
+	}
+	// ʰ ãƼ  out Ѵ.  false
+	bool get(const string& name, cell& out) const {
+		const entry* e = find(name);
+		if (!e) return false;
+		global_reader& r = global_reader::mine();
+		const cell* v = e->value.load(memory_order_acquire);
+		while (true) {//  ڿ  ̸,         .
+			if (v == &taken_mark) {//take    restore  ٸ.
+				this_thread::yield();
+				v = e->value.load(memory_order_acquire);
+				continue;
+			}
+			r.hazard.store(v);
+			const cell* now = e->value.load();
+			if (now == v) break;
+			v = now;
+		}
+		out = *v;
+		r.hazard.store(0, memory_order_release);
+		return true;
+	}
+	//̹   ٲٰ true,  false
+	bool assign(const string& name, const cell& value) {
+		lock_guard<mutex> lock(write_lock);
+		entry* e = find(name);
+		if (e) publish(e, value);
+		return e != 0;
+	}
+	// .
+	void define(const string& name, const cell& value) {
+		lock_guard<mutex> lock(write_lock);
+		define_locked(name, value);
+	}
+	//NCONC   Ʈ  ʰ ڸ ٲ  ֵ name  ǥ   .  0.
+	//   д  ٸ   write_lock Ƿ, restoreϱ   ؼ  ȴ.
+	cell* take(const string& name) {
+		write_lock.lock();
+		entry* e = find(name);
+		if (!e) {
+			write_lock.unlock();
+			return 0;
+		}
+		cell* v = e->value.exchange(&taken_mark);
+		for (global_reader* r = global_reader::head.load(memory_order_acquire); r; r = r->next)
+			while (r->hazard.load() == v) this_thread::yield();//ϴ 尡 ⸦ ٸ.
+		taken = e;
+		return v;
+	}
+	//take    ٽ ܴ.
+	void restore(cell* v) {
+		taken->value.store(v, memory_order_release);
+		taken = 0;
+		write_lock.unlock();
+	}
+	//ó ä (ٸ 尡 б ) . name  cell ڸ ٲ  ְ ش.
+	cell& slot(const string& name) {
+		lock_guard<mutex> lock(write_lock);
+		entry* e = find(name);
+		if (!e) e = define_locked(name, nil);
+		return *e->value.load(memory_order_relaxed);
+	}
+	//  f ѱ.
+	template <class F> void each(F f) {
+		lock_guard<mutex> lock(write_lock);
+		for (size_t i = 0; i < entries.size(); i++) f(*entries[i]->value.load(memory_order_relaxed));
+	}
+
+private:
+	atomic<index*> current;
+	mutex write_lock;
+	size_t count;
+	vector<entry*> entries;
+	vector<index*> retired;
+	vector<cell*> retired_values;
+	entry* taken;//take    ׸
+	static cell taken_mark;//   ׸  ޾ δ ǥ
+
+	entry* find(const string& name) const {//ǥ  Ѱ  Ƿ  ĭ  .
+		size_t h = std::hash<string>()(name);
+		const index* ix = current.load(memory_order_acquire);
+		for (size_t i = h & ix->mask; ; i = (i + 1) & ix->mask) {
+			entry* e = ix->slots[i].load(memory_order_acquire);
+			if (!e) return 0;
+			if (e->hash == h && e->name == name) return e;
+		}
+	}
+	entry* define_locked(const string& name, const cell& value) {
+		entry* e = find(name);
+		if (e) {
+			publish(e, value);
+			return e;
+		}
+		e = new entry(name, std::hash<string>()(name), value);
+		entries.push_back(e);
+		index* ix = current.load(memory_order_relaxed);
+		if (2 * (count + 1) > ix->slots.size()) {
+			index* bigger = new index(ix->slots.size() * 2);
+			for (size_t i = 0; i < ix->slots.size(); i++) {
+				entry* old = ix->slots[i].load(memory_order_relaxed);
+				if (old) put(bigger, old);
+			}
+			current.store(bigger, memory_order_release);
+			retired.push_back(ix);
+			ix = bigger;
+		}
+		put(ix, e);
+		count++;
+		return e;
+	}
+	void publish(entry* e, const cell& value) {
+		retired_values.push_back(e->value.exchange(new cell(value)));
+		if (retired_values.size() >= RECLAIM_BATCH) reclaim();
+	}
+	// 嵵 ϰ     .
+	void reclaim() {
+		vector<const cell*> in_use;
+		for (global_reader* r = global_reader::head.load(memory_order_acquire); r; r = r->next) {
+			const cell* h = r->hazard.load();
+			if (h) in_use.push_back(h);
+		}
+		size_t n = 0;
+		for (size_t i = 0; i < retired_values.size(); i++) {
+			if (std::find(in_use.begin(), in_use.end(), retired_values[i]) != in_use.end()) retired_values[n++] = retired_values[i];
+			else delete retired_values[i];
+		}
+		retired_values.resize(n);
+	}
+	static void put(index* ix, entry* e) {
+		size_t i = e->hash & ix->mask;
+		while (ix->slots[i].load(memory_order_relaxed)) i = (i + 1) & ix->mask;
+		ix->slots[i].store(e, memory_order_release);
+	}
+};
+
+cell global_table::taken_mark;
+
 // ȣ ش  ϰ
 // ߰ Լ Ѵٸ outer ̿Ͽ  dictionary̴
+void gc_track(environment* e);
 struct environment {
 	//  ̸  ش.
 	typedef map<string, cell> map;
+	size_t gc_slot;// heap ö heap ȣ, ƴϸ -1
 
-	environment(environment* outer = 0) : outer_(outer) {}
+	environment(environment* outer = 0) : gc_slot(-1), outer_(outer), captured(false) {
+		if (!outer) globals_.reset(new global_table);
+	}
 
 	environment(const cells& parms, const cells& args, environment* outer)
-		: outer_(outer)
+		: gc_slot(-1), outer_(outer), captured(false)
+	{
+		rebind(parms, args);
+	}
+	// ȯ  ȣ⿡ ٽ   Ű  ڷ ٲ۴.
+	// ȣ⿡ SETQ    .
+	void rebind(const cells& parms, const cells& args)
+	{
+		if (!env_.empty()) env_.clear();
+		if (slots_.size() != parms.size()) {
+			slots_.clear();
+			for (cellit p = parms.begin(); p != parms.end(); ++p)
+				slots_.push_back(slot(p->val, nil));
+		}
+		for (size_t i = 0; i < slots_.size() && i < args.size(); i++)
+			slots_[i].second = args[i];
+	}
+	//  ȯ  outer Ʒ  ȯ ٽ . slots_ 뷮 ״ ´.
+	void reset(environment* outer)
+	{
+		outer_ = outer;
+		captured = false;
+		slots_.clear();
+		if (!env_.empty()) env_.clear();
+	}
+	//LET, Լ ȣ     map  slots_ ʷ ִ´.
+	//     Ƿ ó Ⱦ ã  map .
+	cell& bind(const string& var, const cell& value)
+	{
+		slots_.push_back(slot(var, value));
+		return slots_.back().second;
+	}
+	void reserve(size_t n) { slots_.reserve(n); }
+	// ٱ() ȯ
+	environment* outermost()
+	{
+		environment* e = this;
+		while (e->outer_) e = e->outer_;
+		return e;
+	}
+	// ȯ ǥ.  ٱ ȯ濡 θ.
+	global_table& globals() { return *globals_; }
+	//LAMBDA   ȯ  ǥ д.  ȯ(  ٱ) ϸ  ȴ.
+	//׶ʹ frame_pool ư Ƿ   ô´.
+	void capture()
+	{
+		for (environment* e = this; e && !e->captured.exchange(true, memory_order_relaxed); e = e->outer_)
+			if (e->outer_) gc_track(e);
+	}
+	bool is_captured() const { return captured.load(memory_order_relaxed); }
+	//var  out Ѵ.  false
+	bool get(const string& var, cell& out)
+	{
+		for (environment* e = this; e; e = e->outer_) {
+			for (size_t s = 0; s < e->slots_.size(); s++)
+				if (e->slots_[s].first == var) {
+					out = e->slots_[s].second;
+					return true;
+				}
+			if (e->globals_) return e->globals_->get(var, out);
+			if (e->env_.empty()) continue;//Լ ȣ ȯ 밳 map  ʴ´.
+			shared_lock<shared_mutex> lock(env_lock());
+			map::iterator i = e->env_.find(var);
+			if (i != e->env_.end()) {
+				out = i->second;
+				return true;
+			}
+		}
+		return false;
+	}
+	//var ִ   cell.  ̰ų  0 ش.
+	//   ڸ ٲ Ƿ get а set ٲ۴.
+	cell* lookup_local(const string& var)
+	{
+		for (environment* e = this; e; e = e->outer_) {
+			for (size_t s = 0; s < e->slots_.size(); s++)
+				if (e->slots_[s].first == var) return &e->slots_[s].second;
+			if (e->globals_) return 0;
+			if (e->env_.empty()) continue;
+			shared_lock<shared_mutex> lock(env_lock());
+			map::iterator i = e->env_.find(var);
+			if (i != e->env_.end()) return &i->second;
+		}
+		return 0;
+	}
+	//SETQ. ̹ ִ   ڸ  ٲٰ(ݺ ȿ ٱ    ֵ),
+	//ó    ȯ濡  .
+	void set(const string& var, const cell& value)
 	{
-		cellit a = args.begin();
-		for (cellit p = parms.begin(); p != parms.end(); ++p)
-			env_[p->val] = *a++;
+		for (environment* e = this; e; e = e->outer_) {
+			for (size_t s = 0; s < e->slots_.size(); s++)
+				if (e->slots_[s].first == var) {
+					e->slots_[s].second = value;
+					return;
+				}
+			if (e->globals_) {
+				if (e->globals_->assign(var, value)) return;
+				break;
+			}
+			if (e->env_.empty()) continue;
+			unique_lock<shared_mutex> lock(env_lock());
+			map::iterator i = e->env_.find(var);
+			if (i != e->env_.end()) {
+				i->second = value;
+				return;
+			}
+		}
+		define(var, value);
 	}
-	//string var Ÿ ۷ ȯѴ.
-	map& find(const string& var)
+	//DEFUNó  ȯ濡 var value Ѵ.
+	void define(const string& var, const cell& value)
 	{
-		if (env_.find(var) != env_.end())
-			return env_; // symbol   env Ƿ, ̰ .
-		if (outer_)// Լ  , outer_ 0 1,2,3  ٲǷ
-			//env_Լ ش Լ find   outer ã⸦ Ѵ.
-			return outer_->find(var); // "outer" symbol ã
-		cout << "unbound symbol '" << var << endl;//ƹ͵ ã   .
-		exit(1);
+		if (globals_) globals_->define(var, value);
+		else (*this)[var] = value;
 	}
 
 	//Է var, ش env_  ּڸ ȯѴ.
+	// ȯ濡 add_globalsó ٸ 尡 б  ä  .
 	cell& operator[] (const string& var)
 	{
+		for (size_t s = 0; s < slots_.size(); s++)
+			if (slots_[s].first == var) return slots_[s].second;
+		if (globals_) return globals_->slot(var);
+		unique_lock<shared_mutex> lock(env_lock());
 		return env_[var];
 	}
+	void trace(gc_marker& m) const;
 
 private:
+	typedef pair<string, cell> slot;
+	vector<slot> slots_;// 
 	map env_; //  صξ.
 	environment* outer_; //ƿ ʹ, ο Լ   δ.
+	unique_ptr<global_table> globals_;// ȯ̸ env_  ̰ .
+	atomic<bool> captured;//PMAP   尡  ٱ ȯ   ִ.
 };
 
 //ؿ  ص Լ 漱.
-string str(long n);
+string str(long long n);
 bool isdig(char c);
-bool isfloat(string c);
+bool isfloat(const string& c);
 bool check_float(const cellit& start, const cellit& end);
 string uppercase(string up_string);
 
 
+//ؽ ̺ Ű 񱳿  Լ.
+size_t hash_cell(const cell& c, bool deep);
+size_t hash_raw(const cell& c, bool deep);
+int compare_cells(const cell& a, const cell& b);
+void key_summary(const cell& c, unsigned char& rank, unsigned long long& pre);
+bool cell_eq(const cell& a, const cell& b);
+bool cell_eql(const cell& a, const cell& b);
+bool cell_equal(const cell& a, const cell& b);
+
+
 //////////////////////  Ľϰ, а ϴµ ʿ.
 list<string> tokenize(const string& str); cell atom(const string& token); cell read_from(list<string>& tokens);
-cell read(const string& s); string to_string(const cell& exp); void repl(const string& prompt, environment* env);
-void add_globals(environment& env); cell eval(cell x, environment* env);
-
-///////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////// functions ////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////////////////////////
+cell read(const string& s); string to_string(const cell& exp);
+void add_globals(environment& env); cell eval(const cell& x, environment* env);
+cell eval_body(const cells& forms, size_t from, environment* env);
+void eval_effect(const cell& x, environment* env);
 
-//Լ
-cell proc_add(const cells& c) {
-	bool flag = check_float(c.begin(), c.end());//flag  Ҽ Ǵش.
+//////////////////////  
+//object  ȯ     heap ø. ֻ    ϰ ()
+// ȯ濡  ʴ ͵ (mark-sweep). Ʈ Ҵ shared_ptr  .
+//ǥ Ʈ ü  ƴ϶ gc_marking ιǷ, fork ϲ μ  ü Ⱦ
+//   ʾ θ Բ  (copy-on-write)  ʴ´.
+//ǥô ۾ Ǯ   ϰ,     ƴ϶  ڿ ϲ ϳ  Ѵ.
+const size_t GC_MIN = 10000;//   ̸ŭ(Ǵ ׶ Ƴ ŭ)   ٽ Ѵ.
+const size_t GC_PAGE = 4096;//(sweep)  . heap ȣ ̸ŭ  尡 ô´.
+// heap   ü ȯ. FUTUREó  claim  Ƿ,
+//ϲ  ٻڰų (fork ڽ )    .
+struct gc_sweep {
+	vector<object*> objects;
+	vector<environment*> envs;
+	atomic<int> state;//0: ٸ, 1:  , 2: 
+	mutex lock;
+	condition_variable done;
 
-	if (c.size() != 0) {
-		if (flag) {//Ҽ̸ Ҽ  
-			float n(stof(c[0].val));
-			for (cellit i = c.begin() + 1; i != c.end(); ++i) n += stof(i->val);
-			return cell(Number, to_string(n));
+	gc_sweep() : state(0) {}
+	bool claim() {
+		int expected = 0;
+		return state.compare_exchange_strong(expected, 1);
+	}
+	void run() {
+		for (size_t i = 0; i < objects.size(); i++) delete objects[i];//MAPCAR ȣ  Ҹڿ ȯ Ƿ ȯ ߿ .
+		for (size_t i = 0; i < envs.size(); i++) delete envs[i];
+		{
+			lock_guard<mutex> guard(lock);
+			state.store(2);
 		}
-		else {//   
-			long n(atol(c[0].val.c_str()));
-			for (cellit i = c.begin() + 1; i != c.end(); ++i) n += atol(i->val.c_str());
-			return cell(Number, str(n));
+		done.notify_all();
+	}
+	void finish() {
+		if (claim()) run();
+		else {
+			unique_lock<mutex> guard(lock);
+			done.wait(guard, [this] { return state.load() == 2; });
 		}
 	}
-	else return cell(Number, "0");
+};
+struct gc_heap {
+	mutex lock;
+	vector<object*> objects;// ڸ 0 ΰ free_objects ٽ . ִ  ȣ ٲ ʴ´.
+	vector<environment*> envs;
+	vector<size_t> free_objects, free_envs;
+	size_t live, allocated;//ִ ,     ø 
+	size_t kept;//  Ƴ . live  ڿ   Ƿ    ̰ Ѵ.
+	int busy;// ִ ׸  FUTURE .      Ƿ 0  Ѵ.
+	bool requested;//(GC) ҷ.
+	size_t collections, freed;
+	double pause_ms;//  ɸ ð
+	size_t markers;//  ǥø    
+	shared_ptr<gc_sweep> sweep;//    .      ִ.
 
-}
-cell proc_sub(const cells& c) {//flag  Ҽ Ǵ
-	bool flag = check_float(c.begin(), c.end());
+	gc_heap() : live(0), allocated(0), kept(0), busy(0), requested(false), collections(0), freed(0), pause_ms(0), markers(0) {}
+	~gc_heap() {//ͺ   ü(۾ Ǯ   ) ߿  ⸦ ǵ帮 ʰ Ѵ.
+		finish_sweep();
+		for (size_t i = 0; i < objects.size(); i++) if (objects[i]) objects[i]->heap = 0;
+	}
+	void finish_sweep() {
+		shared_ptr<gc_sweep> s;
+		s.swap(sweep);
+		if (s) s->finish();
+	}
+	template <class T> size_t add(vector<T*>& items, vector<size_t>& free_slots, T* x) {
+		lock_guard<mutex> guard(lock);
+		live++;
+		allocated++;
+		if (free_slots.empty()) {
+			items.push_back(x);
+			return items.size() - 1;
+		}
+		size_t slot = free_slots.back();
+		free_slots.pop_back();
+		items[slot] = x;
+		return slot;
+	}
+	void remove(object* o) {
+		lock_guard<mutex> guard(lock);
+		objects[o->gc_slot] = 0;
+		free_objects.push_back(o->gc_slot);
+		live--;
+	}
+	//׸ 峪 FUTURE  ϰ  . ϴ ȿ  ϰ ٸ.
+	void enter() {
+		lock_guard<mutex> guard(lock);
+		busy++;
+	}
+	void leave() {
+		lock_guard<mutex> guard(lock);
+		busy--;
+	}
+};
+//     ǥ Ʈ.  尡 Բ ѹǷ  ٲ۴.
+struct gc_bits {
+	unique_ptr<atomic<uint64_t>[]> words;
 
-	if (flag) {//Ҽ̸ Ҽ  
-		float n(stof(c[0].val));
-		for (cellit i = c.begin() + 1; i != c.end(); ++i) n -= stof(i->val);
-		if (c.begin() + 1 == c.end()) n *= -1;
-		return cell(Number, to_string(n));
+	gc_bits(size_t n) : words(new atomic<uint64_t>[(n + 63) / 64]()) {}
+	bool set(size_t i) {//̹ ó  true
+		uint64_t bit = (uint64_t)1 << (i % 64);
+		atomic<uint64_t>& w = words[i / 64];
+		if (w.load(memory_order_relaxed) & bit) return false;
+		return !(w.fetch_or(bit, memory_order_relaxed) & bit);
 	}
-	else {//   
-		long n(atol(c[0].val.c_str()));
-		for (cellit i = c.begin() + 1; i != c.end(); ++i) n -= atol(i->val.c_str());
-		if (c.begin() + 1 == c.end()) n *= -1;
-		return cell(Number, str(n));
+	bool test(size_t i) const { return (words[i / 64].load(memory_order_relaxed) >> (i % 64)) & 1; }
+};
+//ǥ   ĭ. cell Ʈ  ȿ ̾ n  ĭ ´.
+struct gc_item {
+	enum kind_type { Cells, Object, Env } kind;
+	const void* p;
+	size_t n;
+};
+struct gc_marking;
+// ϳ ǥ . θ  local,  尡     shared .
+//ġ  shared װ Ƿ,  local  ʰ .
+struct alignas(64) gc_marker {
+	gc_marking& g;
+	size_t id;
+	vector<gc_item> local;
+	mutex lock;
+	vector<gc_item> shared;
+	atomic<size_t> shared_size;
+
+	gc_marker(gc_marking& g, size_t id) : g(g), id(id), shared_size(0) {}
+	void mark(const cell& c) { local.push_back(gc_item{ gc_item::Cells, &c, 1 }); }
+	void mark(const object* o);
+	void mark(const environment* e);
+	void run();//     ȴ´.
+private:
+	bool pop(gc_item& x);
+	bool steal();
+	void publish();
+	void scan(const gc_item& x);
+};
+//    尡 Բ  
+struct gc_marking {
+	gc_heap& heap;
+	const environment* root;// ȯ. ó   ȴ´.
+	gc_bits object_marks, env_marks;
+	struct shard {
+		mutex lock;
+		unordered_set<const cell_block*> blocks;
+	};
+	shard shards[64];// cell Բ  Ʈ   ̹  . ּҷ   ٴ.
+	vector<unique_ptr<gc_marker> > markers;
+	atomic<int> working;//   ִ  
+	atomic<int> hungry;//ĥ  ã  
+
+	gc_marking(gc_heap& heap, const environment* root, size_t threads);
+	bool first_visit(const cell_block* b) {
+		shard& sh = shards[(reinterpret_cast<uintptr_t>(b) >> 6) % 64];
+		lock_guard<mutex> guard(sh.lock);
+		return sh.blocks.insert(b).second;
 	}
-}
-cell proc_mul(const cells& c) {
-	bool flag = check_float(c.begin(), c.end());
+	bool all_empty() const {
+		for (size_t i = 0; i < markers.size(); i++) if (markers[i]->shared_size.load() != 0) return false;
+		return true;
+	}
+	void run();//markers[0]   Ѹ  ְ  忡 ǥѴ.
+};
 
-	if (c.size() != 0) {
-		if (flag) {//Ҽ̸ Ҽ  
-			float n(stof(c[0].val));
-			for (cellit i = c.begin() + 1; i != c.end(); ++i) n *= stof(i->val);
-			return cell(Number, to_string(n));
-		}
-		else {//   
-			long n(1);
-			for (cellit i = c.begin(); i != c.end(); ++i) n *= atol(i->val.c_str());
-			return cell(Number, str(n));
-		}
+////////////////////// 
+// ϳ  .  ȯ,  Ʈ, ؽ ܽ ǥ, ũ ̸  Ƿ
+// μ    帶 ϳ     ִ.
+//nil, true_sym    ٲ Ƿ ΰ Բ .
+struct interpreter {
+	gc_heap heap;// ȯ溸   ߿ ش.
+	environment global_env;
+	istream* in;
+	ostream* out;
+	shared_mutex env_lock;
+	unordered_multimap<size_t, shared_ptr<cell_block> > cons_table;//ؽ ܽ ǥ. ǥ  ִ Ҵ   .
+	size_t cons_kept;//   ǥ  
+	mutex cons_lock;//PMAP ȿ HASH-CONS ҷ ǥ  ʵ, hash_cons ̰  θ.
+	set<string> macro_names;//DEFMACRO ǵ  ִ ̸
+	mutex macro_lock;// 尡     macro_site ȣѴ. ġ   ʴ´.
+
+	interpreter(istream& in = cin, ostream& out = cout);
+	cell eval_line(const string& line);
+	void repl(const string& prompt);
+	bool load(const string& path);
+	void collect(bool force);
+};
+// 尡  ϰ ִ . ۾ Ǯ   ñ   ٲ  .
+thread_local interpreter* current_interpreter = 0;
+interpreter& interp() { return *current_interpreter; }
+shared_mutex& env_lock() { return current_interpreter->env_lock; }
+//eval   ּҺ    ʰ error ش.  Ͱ μ  ʰ Ѵ.
+//׸ 带 ϴ ȿ ϲ   ÿ ° ٲپ д.
+//  ġ stack_overflow Ѽ ٱ   error  Ѵ. interpreter_scope  ٽ .
+enum { STACK_RESERVE = 128 * 1024 };//Ѱ ؿ  δ . ̳ ó eval ġ ʴ Ͱ .
+thread_local const char* stack_limit = 0;
+thread_local bool stack_overflow = false;
+const char* thread_stack_limit(const char* here) {
+#ifdef __linux__
+	pthread_attr_t attr;
+	void* base;
+	size_t size;
+	if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+		pthread_attr_getstack(&attr, &base, &size);
+		pthread_attr_destroy(&attr);
+		return (const char*)base + STACK_RESERVE;
 	}
-	else return cell(Number, "1");
+#endif
+	return here - (1024 * 1024 - STACK_RESERVE);//      ũ(1MB) .
 }
-cell proc_div(const cells& c) {
-	float n(stof(c[0].val));// Ҽ ϰ (/  Ҽ   Ƿ)
-	for (cellit i = c.begin() + 1; i != c.end(); ++i) n /= stof(i->val);
-	if ((c.begin() + 1) == c.end()) n = 1 / n;
-	return cell(Number, to_string(n));
+inline bool stack_exhausted() {
+	char here;
+	if (!stack_limit) stack_limit = thread_stack_limit(&here);
+	return &here < stack_limit;
 }
-cell proc_greater(const cells& c) {//ū
-	bool flag = check_float(c.begin(), c.end());
-
-	if (flag) {//Ҽ̸ Ҽ  
-		float n(stof(c[0].val));
-		for (cellit i = c.begin() + 1; i != c.end(); ++i)
-			if (n <= stof(i->val))
-				return false_sym;
-		return true_sym;
+// ȿ current_interpreter ٲ۴.
+struct interpreter_scope {
+	interpreter* saved;
+	bool saved_overflow;
+	interpreter_scope(interpreter* i) : saved(current_interpreter), saved_overflow(stack_overflow) {
+		current_interpreter = i;
+		stack_overflow = false;
 	}
-	else {//   
-		long n(atol(c[0].val.c_str()));
-		for (cellit i = c.begin() + 1; i != c.end(); ++i)
-			if (n <= atol(i->val.c_str()))
-				return false_sym;
-		return true_sym;
+	~interpreter_scope() {
+		current_interpreter = saved;
+		stack_overflow = saved_overflow;
 	}
+};
+inline interpreter::interpreter(istream& in, ostream& out) : in(&in), out(&out), cons_kept(0) {
+	interpreter_scope scope(this);
+	add_globals(global_env);
+}
+inline object::object() : heap(current_interpreter ? &current_interpreter->heap : 0), gc_slot(0) {
+	if (heap) gc_slot = heap->add(heap->objects, heap->free_objects, this);
+}
+inline object::~object() {
+	if (heap) heap->remove(this);//   heap ̸ 0 ٲ д.
+}
+void gc_track(environment* e) {
+	if (current_interpreter) e->gc_slot = current_interpreter->heap.add(current_interpreter->heap.envs, current_interpreter->heap.free_envs, e);
 }
-cell proc_less(const cells& c) {//
-	bool flag = check_float(c.begin(), c.end());
 
-	if (flag) {//Ҽ̸ Ҽ  
-		float n(stof(c[0].val));
-		for (cellit i = c.begin() + 1; i != c.end(); ++i)
-			if (n >= stof(i->val))
-				return false_sym;
-		return true_sym;
+//ؽ ̺. ̽ dictó (Ű, ) ׸ entries   Ƶΰ,
+//index ׸ ȣ  open addressing( Ž) ǥ .
+//index    ũ  index ,  index ĭ  긶
+//ݾ(MIGRATE_STEPĭ) ű. ׷ ũ⸦ ø    ߴ  .
+struct hashtable : object {
+	struct entry {
+		cell key, value;
+		size_t hash;
+		bool live;
+	};
+	enum { EMPTY = 0u, TOMB = 0xffffffffu };//index  ĭ,  ĭ.  entries ȣ + 1
+	enum { MIGRATE_STEP = 64 };
+
+	bool deep;//EQUAL ϸ true, EQ/EQL̸ false
+	vector<entry> entries;
+	vector<unsigned> index, old_index;
+	size_t migrate_start;//old_index ű  ĭ.  ĭ ؾ Ž ΰ  ʴ´.
+	size_t migrated;//migrate_start ű ĭ 
+	size_t filled;//index EMPTY ƴ ĭ 
+	size_t count;//ִ ׸ 
+
+	hashtable(bool deep) : deep(deep), index(8, EMPTY), migrate_start(0), migrated(0), filled(0), count(0) {}
+	void trace(gc_marker& m) const;
+
+	bool same_key(const entry& e, const cell& key, size_t h) const {
+		return e.hash == h && (deep ? cell_equal(e.key, key) : cell_eql(e.key, key));
 	}
-	else {//   
-		long n(atol(c[0].val.c_str()));
-		for (cellit i = c.begin() + 1; i != c.end(); ++i)
-			if (n >= atol(i->val.c_str()))
-				return false_sym;
-		return true_sym;
+	//key ִ ĭ tab start ĭ ã´.  -1
+	long probe(const vector<unsigned>& tab, const cell& key, size_t h, size_t start) const {
+		size_t mask = tab.size() - 1;
+		for (size_t i = start & mask;; i = (i + 1) & mask) {
+			if (tab[i] == EMPTY) return -1;
+			if (tab[i] != TOMB && same_key(entries[tab[i] - 1], key, h)) return i;
+		}
+	}
+	// index ̹ Űܼ   ǳʶٰ,   ű ù ĭ ã´.
+	long probe_old(const cell& key, size_t h) const {
+		size_t mask = old_index.size() - 1;
+		size_t home = h & mask;
+		if (((home - migrate_start) & mask) < migrated) home = migrate_start + migrated;
+		return probe(old_index, key, h, home);
+	}
+	void place(unsigned slot, size_t h) {
+		size_t mask = index.size() - 1;
+		size_t i = h & mask;
+		while (index[i] != EMPTY) i = (i + 1) & mask;
+		index[i] = slot;
+		filled++;
+	}
+	// index ĭ migrate_start ʷ  index ű .
+	void migrate(size_t steps) {
+		size_t mask = old_index.size() - 1;
+		for (; steps && migrated < old_index.size(); steps--, migrated++) {
+			unsigned& slot = old_index[(migrate_start + migrated) & mask];
+			if (slot != EMPTY && slot != TOMB) place(slot, entries[slot - 1].hash);
+			slot = EMPTY;
+		}
+		if (!old_index.empty() && migrated == old_index.size()) {
+			vector<unsigned>().swap(old_index);
+			migrated = 0;
+		}
+	}
+	// ׸ ִ ׸񺸴  entries ϰ index   ٽ .
+	void compact() {
+		migrate(old_index.size());
+		size_t n = 0;
+		for (size_t i = 0; i < entries.size(); i++)
+			if (entries[i].live) entries[n++] = entries[i];
+		entries.resize(n);
+		size_t size = 8;
+		while (size * 2 < n * 3 + 3) size *= 2;
+		index.assign(size, EMPTY);
+		filled = 0;
+		for (size_t i = 0; i < n; i++) place(i + 1, entries[i].hash);
+	}
+	void grow() {
+		if (!old_index.empty()) migrate(old_index.size());
+		if (entries.size() - count > count) {
+			compact();
+			if ((filled + 1) * 3 <= index.size() * 2) return;
+		}
+		old_index.swap(index);
+		index.assign(old_index.size() * 2, EMPTY);
+		filled = 0;
+		migrated = 0;
+		migrate_start = std::find(old_index.begin(), old_index.end(), (unsigned)EMPTY) - old_index.begin();
 	}
 
-}
-cell proc_less_equal(const cells& c) {//۰ų 
-	bool flag = check_float(c.begin(), c.end());
+	entry* find(const cell& key) {
+		migrate(MIGRATE_STEP);
+		size_t h = hash_cell(key, deep);
+		long i = probe(index, key, h, h);
+		if (i >= 0) return &entries[index[i] - 1];
+		if (!old_index.empty() && (i = probe_old(key, h)) >= 0) return &entries[old_index[i] - 1];
+		return 0;
+	}
+	void put(const cell& key, const cell& value) {
+		entry* e = find(key);
+		if (e) {
+			e->value = value;
+			return;
+		}
+		if ((filled + 1) * 3 > index.size() * 2) grow();
+		entry ne = { key, value, hash_cell(key, deep), true };
+		entries.push_back(ne);
+		place(entries.size(), ne.hash);
+		count++;
+	}
+	// ׸ . heap gc_slot ״ ξ ϹǷ  hashtable  ʴ´.
+	void clear() {
+		vector<entry>().swap(entries);
+		index.assign(8, EMPTY);
+		vector<unsigned>().swap(old_index);
+		migrate_start = migrated = filled = count = 0;
+	}
+	bool remove(const cell& key) {
+		migrate(MIGRATE_STEP);
+		size_t h = hash_cell(key, deep);
+		vector<unsigned>* tab = &index;
+		long i = probe(index, key, h, h);
+		if (i < 0 && !old_index.empty()) {
+			tab = &old_index;
+			i = probe_old(key, h);
+		}
+		if (i < 0) return false;
+		entry& e = entries[(*tab)[i] - 1];
+		e.live = false;
+		e.key = e.value = cell();//  ִ ޸𸮴 ٷ ش.
+		(*tab)[i] = TOMB;
+		count--;
+		return true;
+	}
+};
 
-	if (flag) {//Ҽ̸ Ҽ  
-		float n(stof(c[0].val));
-		for (cellit i = c.begin() + 1; i != c.end(); ++i)
-			if (n > stof(i->val))
-				return false_sym;
-		return true_sym;
+// ִ (OMAP) B+ Ʈ . (leaf) 常  , ٳ next ̾ ־
+//   Ʈ ٽ  ʴ´. Ž    Ű (rank, pre)
+// ʿ پִ 迭 Ƶξ,   ĳ θ а ġ ã  ִ.
+//   cell ü Ѵ.
+struct bnode {
+	enum { MAX = 32 };
+	int n;//Ű 
+	bool leaf;
+	size_t size;//  Ʒ ü Ű  ( )
+	unsigned char rank[MAX];//Ű   ( < ڿ < ɺ < )
+	unsigned long long pre[MAX];//ڴ ũ  Ǵ Ʈ, ڿ  8Ʈ
+	bnode* next;// 
+	bnode* child[MAX];// : child[i]  Ű >= keys[i] (keys[0]  )
+	cell keys[MAX];
+	cell vals[MAX];// 常 
+
+	bnode(bool leaf) : n(0), leaf(leaf), size(0), next(0) {}
+	~bnode() {
+		if (!leaf)
+			for (int i = 0; i < n; i++) delete child[i];
 	}
-	else {//   
-		long n(atol(c[0].val.c_str()));
-		for (cellit i = c.begin() + 1; i != c.end(); ++i)
-			if (n > atol(i->val.c_str()))
-				return false_sym;
-		return true_sym;
+	//i° Ű . key < keys[i] 
+	int cmp(int i, unsigned char r, unsigned long long p, const cell& key) const {
+		if (r != rank[i]) return r < rank[i] ? -1 : 1;
+		if (p != pre[i]) return p < pre[i] ? -1 : 1;
+		return compare_cells(key, keys[i]);
+	}
+	//key ̻ ù ° ġ
+	int lower_bound(unsigned char r, unsigned long long p, const cell& key) const {
+		int lo = 0, hi = n;
+		while (lo < hi) {
+			int mid = (lo + hi) / 2;
+			if (cmp(mid, r, p, key) > 0) lo = mid + 1;
+			else hi = mid;
+		}
+		return lo;
+	}
+	// 忡 key  ڽ ȣ (keys[i] <= key  i,  0)
+	int child_for(unsigned char r, unsigned long long p, const cell& key) const {
+		int lo = 1, hi = n;
+		while (lo < hi) {
+			int mid = (lo + hi) / 2;
+			if (cmp(mid, r, p, key) >= 0) lo = mid + 1;
+			else hi = mid;
+		}
+		return lo - 1;
+	}
+	void set_key(int i, const cell& key) {
+		keys[i] = key;
+		key_summary(key, rank[i], pre[i]);
+	}
+	//i ġ  ĭ ڷ δ.
+	void shift_right(int i) {
+		for (int j = n; j > i; j--) {
+			std::swap(keys[j], keys[j - 1]);
+			rank[j] = rank[j - 1];
+			pre[j] = pre[j - 1];
+			if (leaf) std::swap(vals[j], vals[j - 1]);
+			else child[j] = child[j - 1];
+		}
+		n++;
+	}
+	void shift_left(int i) {
+		for (int j = i; j + 1 < n; j++) {
+			std::swap(keys[j], keys[j + 1]);
+			rank[j] = rank[j + 1];
+			pre[j] = pre[j + 1];
+			if (leaf) std::swap(vals[j], vals[j + 1]);
+			else child[j] = child[j + 1];
+		}
+		n--;
+		keys[n] = cell();
+		if (leaf) vals[n] = cell();
+	}
+	//    ű  带 ش.
+	bnode* split() {
+		bnode* right = new bnode(leaf);
+		int mid = n / 2;
+		for (int i = mid; i < n; i++) {
+			int j = right->n++;
+			std::swap(right->keys[j], keys[i]);
+			right->rank[j] = rank[i];
+			right->pre[j] = pre[i];
+			if (leaf) {
+				std::swap(right->vals[j], vals[i]);
+				right->size++;
+			}
+			else {
+				right->child[j] = child[i];
+				right->size += child[i]->size;
+			}
+		}
+		n = mid;
+		size -= right->size;
+		if (leaf) {
+			right->next = next;
+			next = right;
+		}
+		return right;
 	}
+};
 
-}
-cell proc_greater_equal(const cells& c) {//ũų 
-	bool flag = check_float(c.begin(), c.end());
+//B+ Ʈ   ִ .   带 ġ ʰ α⸸ Ѵ.
+//version Ű ߰/  ö󰡸, ݺڰ ڱⰡ    ȿ Ȯ  .
+struct omap : object {
+	bnode* root;
+	unsigned version;
 
-	if (flag) {//Ҽ̸ Ҽ  
-		float n(stof(c[0].val));
-		for (cellit i = c.begin() + 1; i != c.end(); ++i)
-			if (n < stof(i->val))
-				return false_sym;
-		return true_sym;
+	omap() : root(new bnode(true)), version(0) {}
+	~omap() { delete root; }
+	void trace(gc_marker& m) const;
+
+	bnode* find_leaf(const cell& key, int& pos) const {
+		unsigned char r; unsigned long long p;
+		key_summary(key, r, p);
+		bnode* nd = root;
+		while (!nd->leaf) nd = nd->child[nd->child_for(r, p, key)];
+		pos = nd->lower_bound(r, p, key);
+		return nd;
 	}
-	else {//   
-		long n(atol(c[0].val.c_str()));
-		for (cellit i = c.begin() + 1; i != c.end(); ++i)
-			if (n < atol(i->val.c_str()))
-				return false_sym;
-		return true_sym;
+	cell* get(const cell& key) const {
+		int pos;
+		bnode* leaf = find_leaf(key, pos);
+		// Ű     Ƿ  ٱ .
+		while (leaf && pos == leaf->n) {
+			leaf = leaf->next;
+			pos = 0;
+		}
+		if (leaf && compare_cells(key, leaf->keys[pos]) == 0) return &leaf->vals[pos];
+		return 0;
 	}
-}
-cell proc_numberp(const cells& c) { return c[0].type == Number ? true_sym : false_sym; }
-cell proc_length(const cells& c) { return cell(Number, str(c[0].list.size())); }
-cell proc_null(const cells& c) { return c[0].list.empty() ? true_sym : false_sym; }
-cell proc_car(const cells& c) {
-	if (c[0].list.size() == 0) return c[0];
-	return c[0].list[0];
-}//carԼ ù°  ֹǷ ̷ 
-cell proc_atom(const cells& c) {
+	// Ű ־ true, ִ Ű  ٲ false.  尡  split ´.
+	bool insert(bnode* nd, const cell& key, const cell& val, unsigned char r, unsigned long long p, bnode*& split) {
+		split = 0;
+		if (nd->leaf) {
+			int pos = nd->lower_bound(r, p, key);
+			if (pos < nd->n && nd->cmp(pos, r, p, key) == 0) {
+				nd->vals[pos] = val;
+				return false;
+			}
+			nd->shift_right(pos);
+			nd->set_key(pos, key);
+			nd->vals[pos] = val;
+			nd->size++;
+		}
+		else {
+			int i = nd->child_for(r, p, key);
+			bnode* right;
+			if (!insert(nd->child[i], key, val, r, p, right)) return false;
+			nd->size++;
+			if (right) {
+				nd->shift_right(i + 1);
+				nd->keys[i + 1] = right->keys[0];
+				nd->rank[i + 1] = right->rank[0];
+				nd->pre[i + 1] = right->pre[0];
+				nd->child[i + 1] = right;
+			}
+		}
+		if (nd->n == bnode::MAX) split = nd->split();
+		return true;
+	}
+	void put(const cell& key, const cell& val) {
+		unsigned char r; unsigned long long p;
+		key_summary(key, r, p);
+		bnode* right;
+		if (!insert(root, key, val, r, p, right)) return;
+		version++;
+		if (right) {//Ѹ    δ.
+			bnode* top = new bnode(false);
+			top->n = 2;
+			top->child[0] = root;
+			top->child[1] = right;
+			top->keys[1] = right->keys[0];
+			top->rank[1] = right->rank[0];
+			top->pre[1] = right->pre[0];
+			top->size = root->size + right->size;
+			root = top;
+		}
+	}
+	bool erase(bnode* nd, const cell& key, unsigned char r, unsigned long long p) {
+		if (nd->leaf) {
+			int pos = nd->lower_bound(r, p, key);
+			if (pos == nd->n || nd->cmp(pos, r, p, key) != 0) return false;
+			nd->shift_left(pos);
+			nd->size--;
+			return true;
+		}
+		if (!erase(nd->child[nd->child_for(r, p, key)], key, r, p)) return false;
+		nd->size--;
+		return true;
+	}
+	bool remove(const cell& key) {
+		unsigned char r; unsigned long long p;
+		key_summary(key, r, p);
+		if (!erase(root, key, r, p)) return false;
+		version++;
+		return true;
+	}
+	//key  Ű 
+	size_t rank_of(const cell& key) const {
+		unsigned char r; unsigned long long p;
+		key_summary(key, r, p);
+		size_t before = 0;
+		const bnode* nd = root;
+		while (!nd->leaf) {
+			int i = nd->child_for(r, p, key);
+			for (int j = 0; j < i; j++) before += nd->child[j]->size;
+			nd = nd->child[i];
+		}
+		return before + nd->lower_bound(r, p, key);
+	}
+	// ʺ i° (0) Ű ִ ٰ ġ
+	const bnode* select(size_t i, int& pos) const {
+		if (i >= root->size) return 0;
+		const bnode* nd = root;
+		while (!nd->leaf) {
+			int j = 0;
+			while (i >= nd->child[j]->size) i -= nd->child[j++]->size;
+			nd = nd->child[j];
+		}
+		pos = (int)i;
+		return nd;
+	}
+};
+
+//(lazy) . Ҹ ̸  ʰ, next θ  ϳ ؼ .
+//   Ҵ ٽ   , ׷ ƹ  Էµ  ޸𸮷 óѴ.
+struct stream : object {
+	virtual bool next(cell& out) = 0;// Ҹ out ִ´. ̸ false
+};
+
+//OMAP-RANGE ִ ݺ.   ƹ͵  ʰ, OMAP-NEXT θ 
+// 󰡸 ϳ . ߿  ٲ   Ű ,
+// ϳ  ʾ lo ٽ ã´.
+struct omap_iter : stream {
+	omap* m;
+	const bnode* leaf;
+	int pos;
+	unsigned version;
+	cell last;//  Ű
+	bool started, has_lo, has_hi;
+	cell lo;// Ű (has_lo )
+	cell hi;// Ű  (has_hi )
+
+	omap_iter(omap* m) : m(m), leaf(0), pos(0), version(m->version), started(false), has_lo(false), has_hi(false) {}
+	void trace(gc_marker& g) const;
+
+	//ó  ڸ ã´.
+	void seek() {
+		if (has_lo) {
+			int p;
+			leaf = m->find_leaf(lo, p);
+			pos = p;
+		}
+		else {
+			const bnode* nd = m->root;
+			while (!nd->leaf) nd = nd->child[0];
+			leaf = nd;
+			pos = 0;
+		}
+	}
+
+	// (Ű )  result ִ´. ̸ false
+	bool next(cell& result) {
+		if (version != m->version) {// ٲ last  ġ  ã´.
+			version = m->version;
+			if (started) {
+				int p;
+				leaf = m->find_leaf(last, p);
+				pos = p;
+				if (pos < leaf->n && compare_cells(last, leaf->keys[pos]) == 0) pos++;
+			}
+			else seek();
+		}
+		while (leaf && pos >= leaf->n) {
+			leaf = leaf->next;
+			pos = 0;
+		}
+		if (!leaf || (has_hi && compare_cells(leaf->keys[pos], hi) >= 0)) {
+			leaf = 0;
+			return false;
+		}
+		result = cell(List);
+		result.list.push_back(leaf->keys[pos]);
+		result.list.push_back(leaf->vals[pos]);
+		last = leaf->keys[pos];
+		started = true;
+		pos++;
+		return true;
+	}
+};
+
+//////////////////////  : ǥ
+void hashtable::trace(gc_marker& m) const {
+	for (size_t i = 0; i < entries.size(); i++)
+		if (entries[i].live) {
+			m.mark(entries[i].key);
+			m.mark(entries[i].value);
+		}
+}
+//  Ű ˸. ٿ  Ű ڷ    ֱ ̴.
+void trace_bnode(const bnode* nd, gc_marker& m) {
+	for (int i = 0; i < nd->n; i++) {
+		m.mark(nd->keys[i]);
+		if (nd->leaf) m.mark(nd->vals[i]);
+		else trace_bnode(nd->child[i], m);
+	}
+}
+void omap::trace(gc_marker& m) const { trace_bnode(root, m); }
+void omap_iter::trace(gc_marker& g) const {
+	g.mark(m);
+	g.mark(last);
+	g.mark(lo);
+	g.mark(hi);
+}
+void environment::trace(gc_marker& m) const {
+	for (size_t s = 0; s < slots_.size(); s++) m.mark(slots_[s].second);
+	for (map::const_iterator i = env_.begin(); i != env_.end(); ++i) m.mark(i->second);
+	if (globals_) globals_->each([&m](const cell& c) { m.mark(c); });
+	m.mark(outer_);
+}
+gc_marking::gc_marking(gc_heap& heap, const environment* root, size_t threads)
+	: heap(heap), root(root), object_marks(heap.objects.size()), env_marks(heap.envs.size()), working(0), hungry(0) {
+	for (size_t i = 0; i < max(threads, (size_t)1); i++) markers.push_back(unique_ptr<gc_marker>(new gc_marker(*this, i)));
+}
+void gc_marker::mark(const object* o) {
+	if (o && o->heap == &g.heap && g.object_marks.set(o->gc_slot)) local.push_back(gc_item{ gc_item::Object, o, 0 });
+}
+void gc_marker::mark(const environment* e) {
+	if (!e || e == g.root) return;
+	if (e->gc_slot != (size_t)-1 && !g.env_marks.set(e->gc_slot)) return;//  ȯ(MAPCAR ȣ )   Ų.
+	local.push_back(gc_item{ gc_item::Env, e, 0 });
+}
+// Ʈ ̸ŭ ߶  ÿ  ιǷ, Ұ 鸸 Ʈ ϳ  尡  ȴ´.
+const size_t GC_CHUNK = 256;
+void gc_marker::scan(const gc_item& x) {
+	if (x.kind == gc_item::Object) static_cast<const object*>(x.p)->trace(*this);
+	else if (x.kind == gc_item::Env) static_cast<const environment*>(x.p)->trace(*this);
+	else {
+		const cell* c = static_cast<const cell*>(x.p);
+		size_t n = x.n;
+		if (n > GC_CHUNK) {
+			local.push_back(gc_item{ gc_item::Cells, c + GC_CHUNK, n - GC_CHUNK });
+			n = GC_CHUNK;
+		}
+		for (size_t i = 0; i < n; i++) {
+			if (c[i].obj) mark(c[i].obj);
+			if (c[i].env) mark(c[i].env);
+			const cell_block* b = c[i].list.block();
+			if (b && !b->items.empty() && (!c[i].list.shared() || g.first_visit(b)))//ȥ  Ҵ ٸ  ٽ  ʴ´.
+				local.push_back(gc_item{ gc_item::Cells, &b->items[0], b->items.size() });
+		}
+	}
+}
+//local  Ҵ shared  ´.
+bool gc_marker::pop(gc_item& x) {
+	if (local.empty()) {
+		if (shared_size.load(memory_order_relaxed) == 0) return false;
+		lock_guard<mutex> guard(lock);
+		if (shared.empty()) return false;
+		local.swap(shared);
+		shared_size.store(0);
+	}
+	x = local.back();
+	local.pop_back();
+	return true;
+}
+// 尡 ְ     ȷ, local Ʒ ( , 밳  ū ) ´.
+void gc_marker::publish() {
+	if (local.size() < 2 || g.hungry.load(memory_order_relaxed) == 0 || shared_size.load(memory_order_relaxed) != 0) return;
+	size_t half = local.size() / 2;
+	lock_guard<mutex> guard(lock);
+	shared.assign(local.begin(), local.begin() + half);
+	local.erase(local.begin(), local.begin() + half);
+	shared_size.store(half);
+}
+//ٸ  shared  ´.
+bool gc_marker::steal() {
+	for (size_t k = 1; k < g.markers.size(); k++) {
+		gc_marker& v = *g.markers[(id + k) % g.markers.size()];
+		if (v.shared_size.load(memory_order_relaxed) == 0) continue;
+		lock_guard<mutex> guard(v.lock);
+		if (v.shared.empty()) continue;
+		size_t take = (v.shared.size() + 1) / 2;
+		local.insert(local.end(), v.shared.end() - take, v.shared.end());
+		v.shared.resize(v.shared.size() - take);
+		v.shared_size.store(v.shared.size());
+		g.working.fetch_add(1);// ä ÷, ű ̿ ٸ 尡  ٰ  ʴ´.
+		return true;
+	}
+	return false;
+}
+//  尡   ͵  . ʰ       ٷ ư.
+void gc_marker::run() {
+	g.working.fetch_add(1);
+	while (true) {
+		gc_item x;
+		while (pop(x)) {
+			scan(x);
+			publish();
+		}
+		g.working.fetch_sub(1);
+		g.hungry.fetch_add(1);
+		bool found;
+		while (!(found = steal()) && (g.working.load() != 0 || !g.all_empty())) this_thread::yield();
+		g.hungry.fetch_sub(1);
+		if (!found) return;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////// simd ////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////
+
+//   Ŀε.   scalar/SSE2/AVX2    ΰ,
+//α׷ ó   CPU ϴ     Լ  ǥ ִ´.
+void add_f_scalar(const double* a, const double* b, double* r, size_t n) { for (size_t i = 0; i < n; i++) r[i] = a[i] + b[i]; }
+void mul_f_scalar(const double* a, const double* b, double* r, size_t n) { for (size_t i = 0; i < n; i++) r[i] = a[i] * b[i]; }
+double sum_f_scalar(const double* a, size_t n) {
+	double s = 0;
+	for (size_t i = 0; i < n; i++) s += a[i];
+	return s;
+}
+double dot_f_scalar(const double* a, const double* b, size_t n) {
+	double s = 0;
+	for (size_t i = 0; i < n; i++) s += a[i] * b[i];
+	return s;
+}
+double min_f_scalar(const double* a, size_t n) { return *min_element(a, a + n); }
+double max_f_scalar(const double* a, size_t n) { return *max_element(a, a + n); }
+void axpy_f_scalar(double a, const double* x, double* y, size_t n) { for (size_t i = 0; i < n; i++) y[i] += a * x[i]; }
+long long sum_i_scalar(const long long* a, size_t n) {
+	long long s = 0;
+	for (size_t i = 0; i < n; i++) s += a[i];
+	return s;
+}
+
+#ifdef SIMD_X86
+TARGET_SSE2 void add_f_sse2(const double* a, const double* b, double* r, size_t n) {
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2) _mm_storeu_pd(r + i, _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+	for (; i < n; i++) r[i] = a[i] + b[i];
+}
+TARGET_SSE2 void mul_f_sse2(const double* a, const double* b, double* r, size_t n) {
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2) _mm_storeu_pd(r + i, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+	for (; i < n; i++) r[i] = a[i] * b[i];
+}
+TARGET_SSE2 double sum_f_sse2(const double* a, size_t n) {
+	__m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {//⸦   Ἥ  ð .
+		s0 = _mm_add_pd(s0, _mm_loadu_pd(a + i));
+		s1 = _mm_add_pd(s1, _mm_loadu_pd(a + i + 2));
+	}
+	double t[2]; _mm_storeu_pd(t, _mm_add_pd(s0, s1));
+	double s = t[0] + t[1];
+	for (; i < n; i++) s += a[i];
+	return s;
+}
+TARGET_SSE2 double dot_f_sse2(const double* a, const double* b, size_t n) {
+	__m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+		s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+	}
+	double t[2]; _mm_storeu_pd(t, _mm_add_pd(s0, s1));
+	double s = t[0] + t[1];
+	for (; i < n; i++) s += a[i] * b[i];
+	return s;
+}
+TARGET_SSE2 double min_f_sse2(const double* a, size_t n) {
+	if (n < 2) return a[0];
+	__m128d m = _mm_loadu_pd(a);
+	size_t i = 2;
+	for (; i + 2 <= n; i += 2) m = _mm_min_pd(m, _mm_loadu_pd(a + i));
+	double t[2]; _mm_storeu_pd(t, m);
+	double r = t[0] < t[1] ? t[0] : t[1];
+	for (; i < n; i++) if (a[i] < r) r = a[i];
+	return r;
+}
+TARGET_SSE2 double max_f_sse2(const double* a, size_t n) {
+	if (n < 2) return a[0];
+	__m128d m = _mm_loadu_pd(a);
+	size_t i = 2;
+	for (; i + 2 <= n; i += 2) m = _mm_max_pd(m, _mm_loadu_pd(a + i));
+	double t[2]; _mm_storeu_pd(t, m);
+	double r = t[0] > t[1] ? t[0] : t[1];
+	for (; i < n; i++) if (a[i] > r) r = a[i];
+	return r;
+}
+TARGET_SSE2 void axpy_f_sse2(double a, const double* x, double* y, size_t n) {
+	__m128d va = _mm_set1_pd(a);
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2) _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(va, _mm_loadu_pd(x + i))));
+	for (; i < n; i++) y[i] += a * x[i];
+}
+TARGET_SSE2 long long sum_i_sse2(const long long* a, size_t n) {
+	__m128i s = _mm_setzero_si128();
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2) s = _mm_add_epi64(s, _mm_loadu_si128((const __m128i*)(a + i)));
+	long long t[2]; _mm_storeu_si128((__m128i*)t, s);
+	long long r = t[0] + t[1];
+	for (; i < n; i++) r += a[i];
+	return r;
+}
+
+TARGET_AVX2 void add_f_avx2(const double* a, const double* b, double* r, size_t n) {
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) _mm256_storeu_pd(r + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+	for (; i < n; i++) r[i] = a[i] + b[i];
+}
+TARGET_AVX2 void mul_f_avx2(const double* a, const double* b, double* r, size_t n) {
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) _mm256_storeu_pd(r + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+	for (; i < n; i++) r[i] = a[i] * b[i];
+}
+TARGET_AVX2 double sum_f_avx2(const double* a, size_t n) {
+	__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		s0 = _mm256_add_pd(s0, _mm256_loadu_pd(a + i));
+		s1 = _mm256_add_pd(s1, _mm256_loadu_pd(a + i + 4));
+	}
+	double t[4]; _mm256_storeu_pd(t, _mm256_add_pd(s0, s1));
+	double s = t[0] + t[1] + t[2] + t[3];
+	for (; i < n; i++) s += a[i];
+	return s;
+}
+TARGET_AVX2 double dot_f_avx2(const double* a, const double* b, size_t n) {
+	__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+		s1 = _mm256_add_pd(s1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+	}
+	double t[4]; _mm256_storeu_pd(t, _mm256_add_pd(s0, s1));
+	double s = t[0] + t[1] + t[2] + t[3];
+	for (; i < n; i++) s += a[i] * b[i];
+	return s;
+}
+TARGET_AVX2 double min_f_avx2(const double* a, size_t n) {
+	if (n < 4) return min_f_scalar(a, n);
+	__m256d m = _mm256_loadu_pd(a);
+	size_t i = 4;
+	for (; i + 4 <= n; i += 4) m = _mm256_min_pd(m, _mm256_loadu_pd(a + i));
+	double t[4]; _mm256_storeu_pd(t, m);
+	double r = min_f_scalar(t, 4);
+	for (; i < n; i++) if (a[i] < r) r = a[i];
+	return r;
+}
+TARGET_AVX2 double max_f_avx2(const double* a, size_t n) {
+	if (n < 4) return max_f_scalar(a, n);
+	__m256d m = _mm256_loadu_pd(a);
+	size_t i = 4;
+	for (; i + 4 <= n; i += 4) m = _mm256_max_pd(m, _mm256_loadu_pd(a + i));
+	double t[4]; _mm256_storeu_pd(t, m);
+	double r = max_f_scalar(t, 4);
+	for (; i < n; i++) if (a[i] > r) r = a[i];
+	return r;
+}
+TARGET_AVX2 void axpy_f_avx2(double a, const double* x, double* y, size_t n) {
+	__m256d va = _mm256_set1_pd(a);
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		_mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(y + i), _mm256_mul_pd(va, _mm256_loadu_pd(x + i))));
+		_mm256_storeu_pd(y + i + 4, _mm256_add_pd(_mm256_loadu_pd(y + i + 4), _mm256_mul_pd(va, _mm256_loadu_pd(x + i + 4))));
+	}
+	for (; i < n; i++) y[i] += a * x[i];
+}
+TARGET_AVX2 long long sum_i_avx2(const long long* a, size_t n) {
+	__m256i s = _mm256_setzero_si256();
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) s = _mm256_add_epi64(s, _mm256_loadu_si256((const __m256i*)(a + i)));
+	long long t[4]; _mm256_storeu_si256((__m256i*)t, s);
+	long long r = t[0] + t[1] + t[2] + t[3];
+	for (; i < n; i++) r += a[i];
+	return r;
+}
+#endif
+
+//CPU AVX2 ϰ, ü ymm ͸ ִ ȮѴ.
+bool cpu_has_avx2() {
+#if defined(SIMD_X86) && defined(__GNUC__)
+	return __builtin_cpu_supports("avx2");
+#elif defined(SIMD_X86)
+	int info[4];
+	__cpuid(info, 1);
+	if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6) return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+}
+bool cpu_has_sse2() {
+#if defined(SIMD_X86) && defined(__GNUC__)
+	return __builtin_cpu_supports("sse2");
+#elif defined(SIMD_X86)
+	return true;//x64 SSE2 ׻ ִ.
+#else
+	return false;
+#endif
+}
+
+struct simd_table {
+	void (*add_f)(const double*, const double*, double*, size_t);
+	void (*mul_f)(const double*, const double*, double*, size_t);
+	double (*sum_f)(const double*, size_t);
+	double (*dot_f)(const double*, const double*, size_t);
+	double (*min_f)(const double*, size_t);
+	double (*max_f)(const double*, size_t);
+	void (*axpy_f)(double, const double*, double*, size_t);//y += a * x
+	long long (*sum_i)(const long long*, size_t);
+};
+
+simd_table pick_kernels() {
+	simd_table t = { add_f_scalar, mul_f_scalar, sum_f_scalar, dot_f_scalar, min_f_scalar, max_f_scalar, axpy_f_scalar, sum_i_scalar };
+#ifdef SIMD_X86
+	if (cpu_has_avx2()) {
+		simd_table avx2 = { add_f_avx2, mul_f_avx2, sum_f_avx2, dot_f_avx2, min_f_avx2, max_f_avx2, axpy_f_avx2, sum_i_avx2 };
+		return avx2;
+	}
+	if (cpu_has_sse2()) {
+		simd_table sse2 = { add_f_sse2, mul_f_sse2, sum_f_sse2, dot_f_sse2, min_f_sse2, max_f_sse2, axpy_f_sse2, sum_i_sse2 };
+		return sse2;
+	}
+#endif
+	return t;
+}
+
+//ó ȣ    CPU ˻Ѵ.
+const simd_table& kernels() {
+	static const simd_table table = pick_kernels();
+	return table;
+}
+
+////////////////////// ۾ ġ(work-stealing)  Ǯ
+struct pool_job {
+	const function<void(size_t, size_t)>* body;
+	size_t grain;
+	atomic<size_t> remaining;//   ε . 0 Ǹ job ٸ 尡 ư.
+};
+struct pool_task {
+	pool_job* job;
+	size_t lo, hi;
+};
+//Chase-Lev .  常 bottom ʿ push/popϰ, ٸ  top ʿ stealѴ.
+//ũ⸦ ø Ƿ   push ϰ, ׶  ʰ  Ѵ.
+struct alignas(64) ws_deque {
+	enum { CAP = 1024 };
+	atomic<long> top, bottom;
+	atomic<pool_task*> buf[CAP];
+
+	ws_deque() : top(0), bottom(0) {}
+	bool push(pool_task* x) {
+		long b = bottom.load(memory_order_relaxed), t = top.load(memory_order_acquire);
+		if (b - t >= CAP) return false;
+		buf[b % CAP].store(x, memory_order_release);
+		atomic_thread_fence(memory_order_release);
+		bottom.store(b + 1, memory_order_relaxed);
+		return true;
+	}
+	pool_task* pop() {
+		long b = bottom.load(memory_order_relaxed) - 1;
+		bottom.store(b, memory_order_relaxed);
+		atomic_thread_fence(memory_order_seq_cst);
+		long t = top.load(memory_order_relaxed);
+		if (t > b) {// ־.
+			bottom.store(b + 1, memory_order_relaxed);
+			return 0;
+		}
+		pool_task* x = buf[b % CAP].load(memory_order_relaxed);
+		if (t == b) {// ϳ steal Ѵ.
+			if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) x = 0;
+			bottom.store(b + 1, memory_order_relaxed);
+		}
+		return x;
+	}
+	bool empty() const { return top.load(memory_order_acquire) >= bottom.load(memory_order_acquire); }
+	pool_task* steal() {
+		long t = top.load(memory_order_acquire);
+		atomic_thread_fence(memory_order_seq_cst);
+		long b = bottom.load(memory_order_acquire);
+		if (t >= b) return 0;
+		pool_task* x = buf[t % CAP].load(memory_order_acquire);
+		if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) return 0;
+		return x;
+	}
+};
+//ھ ŭ . ó parallel_for θ 尡 0  ,  Ǯ  ϲ 尡 ´.
+//ϲ    α׷   ,    wake . ̳ inbox  ִ 
+// ϲ   ϳ .
+//  ٸ (--serve , ׸  ϲ ) θ  ü inbox ϲۿ Ѱ
+// ϰ,   finished ܴ.
+//fork ڽĿ ϲ 尡  ʰ, θ ϲ  ִ ݵ  ä ǹǷ
+//ڽĿ ϲ   Ǯ ٲ۴. ׷ run submit ڽ 忡  ȴ.
+class work_pool {
+public:
+	static work_pool& get() {
+		static once_flag made;
+		call_once(made, [] {
+			instance = new work_pool(thread::hardware_concurrency());//ϲ   Ƿ  ʴ´.
+#ifndef _WIN32
+			pthread_atfork(0, 0, [] {
+				instance = new work_pool(1);// Ǯ  㿩   Ƿ  ʰ .
+				slot = -1;
+			});
+#endif
+		});
+		return *instance;
+	}
+	size_t size() const { return deques.size(); }
+
+	void run(size_t n, size_t grain, const function<void(size_t, size_t)>& body) {
+		if (slot == -1 && !claim_owner()) slot = -2;
+		if (size() < 2 || n <= grain) {
+			body(0, n);
+			return;
+		}
+		pool_job job;
+		job.body = &body;
+		job.grain = grain;
+		job.remaining.store(n, memory_order_relaxed);
+		pool_task* whole = new pool_task{ &job, 0, n };
+		if (slot < 0) post([this, whole] { execute(whole); });
+		else {
+			execute(whole);
+			for (pool_task* t; (t = find_task()) != 0;) execute(t);//ٸ  ٸ  ´.
+		}
+		unique_lock<mutex> lock(sleep_lock);//  ٸ 尡 ϰ ִ.
+		finished.wait(lock, [&job] { return job.remaining.load(memory_order_acquire) == 0; });
+	}
+	//f ϲ  ϳ ñ ٷ ư. ϲ  false ְ ƹ͵  ʴ´.
+	bool submit(const function<void()>& f) {
+		if (size() < 2) return false;
+		post(f);
+		return true;
+	}
+
+private:
+	vector<ws_deque*> deques;
+	atomic<bool> owned;
+	mutex inbox_lock;
+	list<function<void()> > inbox;//submit ,    ϰ   尡 ñ 
+	atomic<int> queued;//inbox   .    ʰ .
+	atomic<int> sleepers;//wake ڰ ְų ڷ ϲ 
+	mutex sleep_lock;
+	condition_variable wake;// .
+	condition_variable finished;//run  ϳ  .
+	static thread_local int slot;//   ȣ. -1  , -2  .
+	static work_pool* instance;
+
+	explicit work_pool(size_t n) : owned(false), queued(0), sleepers(0) {
+		n = max(n, (size_t)1);
+		for (size_t i = 0; i < n; i++) deques.push_back(new ws_deque);
+		for (size_t i = 1; i < n; i++) thread(&work_pool::work, this, (int)i).detach();
+	}
+	bool claim_owner() {
+		bool expected = false;
+		if (!owned.compare_exchange_strong(expected, true)) return false;
+		slot = 0;
+		return true;
+	}
+	void work(int s) {
+		slot = s;
+		while (true) {
+			pool_task* t = find_task();
+			if (t) execute(t);
+			else if (!run_inbox()) sleep();
+		}
+	}
+	//   ܴ.  sleepers ø  ٽ Ƿ,  ̿   notify .
+	void sleep() {
+		unique_lock<mutex> lock(sleep_lock);
+		sleepers.fetch_add(1);
+		atomic_thread_fence(memory_order_seq_cst);
+		if (!has_work()) wake.wait(lock);
+		sleepers.fetch_sub(1);
+	}
+	bool has_work() const {
+		if (queued.load(memory_order_relaxed) != 0) return true;
+		for (size_t i = 0; i < size(); i++)
+			if (!deques[i]->empty()) return true;
+		return false;
+	}
+	//   θ.  ϲ  ϳ .
+	void notify() {
+		atomic_thread_fence(memory_order_seq_cst);
+		if (sleepers.load(memory_order_relaxed) == 0) return;
+		{ lock_guard<mutex> lock(sleep_lock); }
+		wake.notify_one();
+	}
+	void post(const function<void()>& f) {
+		{
+			lock_guard<mutex> lock(inbox_lock);
+			inbox.push_back(f);
+		}
+		queued.fetch_add(1);
+		notify();
+	}
+	bool run_inbox() {
+		function<void()> f;
+		{
+			lock_guard<mutex> lock(inbox_lock);
+			if (inbox.empty()) return false;
+			f.swap(inbox.front());
+			inbox.pop_front();
+		}
+		queued.fetch_sub(1);
+		f();
+		return true;
+	}
+	//ڱ   ,  ٸ  ģ.
+	pool_task* find_task() {
+		pool_task* t = deques[slot]->pop();
+		for (size_t i = 1; !t && i < size(); i++)
+			t = deques[(slot + i) % size()]->steal();
+		return t;
+	}
+	// grain ũ    ־ ٸ 尡  ϰ,   .
+	void execute(pool_task* t) {
+		pool_job* job = t->job;
+		size_t lo = t->lo, hi = t->hi;
+		delete t;
+		while (hi - lo > job->grain) {
+			size_t mid = lo + (hi - lo) / 2;
+			pool_task* right = new pool_task{ job, mid, hi };
+			if (!deques[slot]->push(right)) {
+				delete right;
+				break;
+			}
+			notify();
+			hi = mid;
+		}
+		(*job->body)(lo, hi);
+		if (job->remaining.fetch_sub(hi - lo, memory_order_acq_rel) != hi - lo) return;// ڷδ job   ִ.
+		{ lock_guard<mutex> lock(sleep_lock); }// ̸ run ٸ 带 .
+		finished.notify_all();
+	}
+};
+thread_local int work_pool::slot = -1;
+work_pool* work_pool::instance = 0;
+
+//[0, n)  grain ũ   work_pool 鿡 f(, ) Ѵ.
+// grain     ũǷ ׳  忡 Ѵ.
+template <class F>
+void parallel_for(size_t n, size_t grain, F f) {
+	interpreter* owner = current_interpreter;
+	work_pool::get().run(n, max(grain, (size_t)1), [owner, &f](size_t lo, size_t hi) {
+		interpreter_scope scope(owner);
+		f(lo, hi);
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////// functions ////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////////////////
+
+//Լ
+//  Լ ڰ    Ѵ.
+bool all_numbers(const cells& c) {
+	for (cellit i = c.begin(); i != c.end(); ++i)
+		if (i->type != Number) return false;
+	return true;
+}
+cell proc_add(const cells& c) {
+	if (!all_numbers(c)) return error;
+	bool flag = check_float(c.begin(), c.end());//flag  Ҽ Ǵش.
+
+	if (c.size() != 0) {
+		if (flag) {//Ҽ̸ Ҽ  
+			float n(strtof(c[0].val.c_str(), 0));
+			for (cellit i = c.begin() + 1; i != c.end(); ++i) n += strtof(i->val.c_str(), 0);
+			return cell(Number, to_string(n));
+		}
+		else {//   
+			long n(atol(c[0].val.c_str()));
+			for (cellit i = c.begin() + 1; i != c.end(); ++i) n += atol(i->val.c_str());
+			return cell(Number, str(n));
+		}
+	}
+	else return cell(Number, "0");
+
+}
+cell proc_sub(const cells& c) {//flag  Ҽ Ǵ
+	if (!all_numbers(c)) return error;
+	bool flag = check_float(c.begin(), c.end());
+
+	if (flag) {//Ҽ̸ Ҽ  
+		float n(strtof(c[0].val.c_str(), 0));
+		for (cellit i = c.begin() + 1; i != c.end(); ++i) n -= strtof(i->val.c_str(), 0);
+		if (c.begin() + 1 == c.end()) n *= -1;
+		return cell(Number, to_string(n));
+	}
+	else {//   
+		long n(atol(c[0].val.c_str()));
+		for (cellit i = c.begin() + 1; i != c.end(); ++i) n -= atol(i->val.c_str());
+		if (c.begin() + 1 == c.end()) n *= -1;
+		return cell(Number, str(n));
+	}
+}
+cell proc_mul(const cells& c) {
+	if (!all_numbers(c)) return error;
+	bool flag = check_float(c.begin(), c.end());
+
+	if (c.size() != 0) {
+		if (flag) {//Ҽ̸ Ҽ  
+			float n(strtof(c[0].val.c_str(), 0));
+			for (cellit i = c.begin() + 1; i != c.end(); ++i) n *= strtof(i->val.c_str(), 0);
+			return cell(Number, to_string(n));
+		}
+		else {//   
+			long n(1);
+			for (cellit i = c.begin(); i != c.end(); ++i) n *= atol(i->val.c_str());
+			return cell(Number, str(n));
+		}
+	}
+	else return cell(Number, "1");
+}
+cell proc_div(const cells& c) {
+	if (!all_numbers(c)) return error;
+	float n(strtof(c[0].val.c_str(), 0));// Ҽ ϰ (/  Ҽ   Ƿ)
+	for (cellit i = c.begin() + 1; i != c.end(); ++i) n /= strtof(i->val.c_str(), 0);
+	if ((c.begin() + 1) == c.end()) n = 1 / n;
+	return cell(Number, to_string(n));
+}
+cell proc_greater(const cells& c) {//ū
+	if (!all_numbers(c)) return error;
+	bool flag = check_float(c.begin(), c.end());
+
+	if (flag) {//Ҽ̸ Ҽ  
+		float n(strtof(c[0].val.c_str(), 0));
+		for (cellit i = c.begin() + 1; i != c.end(); ++i)
+			if (n <= strtof(i->val.c_str(), 0))
+				return false_sym;
+		return true_sym;
+	}
+	else {//   
+		long n(atol(c[0].val.c_str()));
+		for (cellit i = c.begin() + 1; i != c.end(); ++i)
+			if (n <= atol(i->val.c_str()))
+				return false_sym;
+		return true_sym;
+	}
+}
+cell proc_less(const cells& c) {//
+	if (!all_numbers(c)) return error;
+	bool flag = check_float(c.begin(), c.end());
+
+	if (flag) {//Ҽ̸ Ҽ  
+		float n(strtof(c[0].val.c_str(), 0));
+		for (cellit i = c.begin() + 1; i != c.end(); ++i)
+			if (n >= strtof(i->val.c_str(), 0))
+				return false_sym;
+		return true_sym;
+	}
+	else {//   
+		long n(atol(c[0].val.c_str()));
+		for (cellit i = c.begin() + 1; i != c.end(); ++i)
+			if (n >= atol(i->val.c_str()))
+				return false_sym;
+		return true_sym;
+	}
+
+}
+cell proc_less_equal(const cells& c) {//۰ų 
+	if (!all_numbers(c)) return error;
+	bool flag = check_float(c.begin(), c.end());
+
+	if (flag) {//Ҽ̸ Ҽ  
+		float n(strtof(c[0].val.c_str(), 0));
+		for (cellit i = c.begin() + 1; i != c.end(); ++i)
+			if (n > strtof(i->val.c_str(), 0))
+				return false_sym;
+		return true_sym;
+	}
+	else {//   
+		long n(atol(c[0].val.c_str()));
+		for (cellit i = c.begin() + 1; i != c.end(); ++i)
+			if (n > atol(i->val.c_str()))
+				return false_sym;
+		return true_sym;
+	}
+
+}
+cell proc_greater_equal(const cells& c) {//ũų 
+	if (!all_numbers(c)) return error;
+	bool flag = check_float(c.begin(), c.end());
+
+	if (flag) {//Ҽ̸ Ҽ  
+		float n(strtof(c[0].val.c_str(), 0));
+		for (cellit i = c.begin() + 1; i != c.end(); ++i)
+			if (n < strtof(i->val.c_str(), 0))
+				return false_sym;
+		return true_sym;
+	}
+	else {//   
+		long n(atol(c[0].val.c_str()));
+		for (cellit i = c.begin() + 1; i != c.end(); ++i)
+			if (n < atol(i->val.c_str()))
+				return false_sym;
+		return true_sym;
+	}
+}
+cell proc_numberp(const cells& c) { return c[0].type == Number ? true_sym : false_sym; }
+cell proc_length(const cells& c) {
+	if (c[0].type == Vector) return cell(Number, str((long long)static_cast<numvec*>(c[0].obj)->size()));
+	return cell(Number, str(c[0].list.size()));
+}
+cell proc_null(const cells& c) { return c[0].list.empty() ? true_sym : false_sym; }
+cell proc_car(const cells& c) {
+	if (c[0].list.size() == 0) return c[0];
+	return c[0].list[0];
+}//carԼ ù°  ֹǷ ̷ 
+cell proc_atom(const cells& c) {
 	/*
 	(atom nil) => T
 	(atom 'some-symbol) => T
@@ -267,119 +2036,3050 @@ cell proc_atom(const cells& c) {
 	return (c[0].type == Symbol || c[0].type == String || c[0].type == Number) ? true_sym : nil;
 }
 
-cell proc_cdr(const cells& c)
-{
-	if (c[0].list.size() == 0) return c[0];
-	if (c[0].list.size() < 2)
+cell proc_cdr(const cells& c)
+{
+	if (c[0].list.size() == 0) return c[0];
+	if (c[0].list.size() < 2)
+		return nil;
+	cell result(c[0]);
+	result.list.erase(result.list.begin());//ù°  ϰ ؾϹǷ 
+	return result;
+}
+cell proc_append(const cells& c) {// Ʈ ϳ ִ Լ
+	cell result(List);
+	if (c.empty()) return result;
+	result.list = c[0].list;
+	for (int k = 1; k < c.size(); k++) {
+		for (cellit i = c[k].list.begin(); i != c[k].list.end(); ++i) result.list.push_back(*i);
+	}
+	return result;
+}
+cell proc_cons(const cells& c)
+{
+	cell result(List);
+	result.list.push_back(c[0]);
+	for (cellit i = c[1].list.begin(); i != c[1].list.end(); ++i) result.list.push_back(*i);
+	return result;
+}
+cell proc_list(const cells& c)
+{
+	cell result(List); result.list = c;
+	return result;
+}
+cell proc_reverse(const cells& c) {
+	cell result(List);
+	result.list = c[0].list;
+	reverse(result.list.begin(), result.list.end());
+	return result;
+}
+cell proc_minusp(const cells& c) {
+	if (c[0].type != Number) return error;
+	return c[0].val.find('-') == string::npos ? false_sym : true_sym;
+}
+cell proc_zerop(const cells& c) {
+	if (c[0].type != Number) return error;
+	return c[0].val == "0" ? true_sym : false_sym;
+}
+cell proc_equal(const cells& c) {//(=  ...)     
+	if (!all_numbers(c)) return error;
+	bool flag = check_float(c.begin(), c.end());
+
+	if (flag) {
+		float n(strtof(c[0].val.c_str(), 0));
+		for (cellit i = c.begin() + 1; i != c.end(); ++i)
+			if (n != strtof(i->val.c_str(), 0))
+				return false_sym;
+		return true_sym;
+	}
+	else {
+		long n(atol(c[0].val.c_str()));
+		for (cellit i = c.begin() + 1; i != c.end(); ++i)
+			if (n != atol(i->val.c_str()))
+				return false_sym;
+		return true_sym;
+	}
+}
+cell proc_stringp(const cells& c) {
+	return c[0].type == String ? true_sym : nil;
+}
+cell proc_print(const cells& c) {
+	return c[0];
+}
+
+////////////////////// Լ ȣ
+//Լ ȣ LET   ȯ Ź new  ʰ frame_pool   ´.
+// Ŭ ȯ   ʴ´.
+thread_local vector<environment*> frame_pool;//帶  д.
+struct scoped_frame {
+	environment* env;
+
+	scoped_frame(environment* outer, size_t nslots = 0) {
+		if (frame_pool.empty()) env = new environment(outer);
+		else {
+			env = frame_pool.back();
+			frame_pool.pop_back();
+			env->reset(outer);
+		}
+		env->reserve(nslots);//bind  cell&    Ű ʵ
+	}
+	~scoped_frame() {
+		if (!env->is_captured()) frame_pool.push_back(env);
+	}
+	environment* operator->() const { return env; }
+};
+//Լ θ. ڰ ڶ θ ʰ error ش.
+size_t min_args(cell::proc_type p);
+inline cell call_proc(cell::proc_type p, const cells& args) {
+	if (args.size() < min_args(p)) {
+		if (current_interpreter) *interp().out << "too few arguments\n";
+		return error;
+	}
+	return p(args);
+}
+//MAPCAR, REDUCEó  Լ   θ Լ  ȣ.
+//  args Lambda ȯ(frame)    ȣ⸶ ٽ .
+// Ŭ  frame   frame Ƶΰ  ȣ  .
+struct caller {
+	cell fn;
+	cells args;//ȣ  ⿡ ڸ ä.
+	environment* frame;
+
+	caller(const cell& fn, size_t nargs = 0) : fn(fn), args(nargs), frame(0) {}
+	caller(const caller&) = delete;
+	caller(caller&& o) : fn(o.fn), args(std::move(o.args)), frame(o.frame) { o.frame = 0; }
+	~caller() {//  frame frame_pool ´.
+		if (frame && !frame->is_captured()) frame_pool.push_back(frame);
+	}
+	void trace(gc_marker& m) const {
+		m.mark(fn);
+		for (size_t i = 0; i < args.size(); i++) m.mark(args[i]);
+		m.mark(frame);
+	}
+
+	cell call() {
+		if (fn.type == Proc) return call_proc(fn.proc, args);
+		if (fn.type != Lambda) return error;
+		if (!frame || frame->is_captured()) frame = new environment(fn.list[1].list, args, fn.env);
+		else frame->rebind(fn.list[1].list, args);
+		return eval_body(fn.list, 2, frame);
+	}
+};
+//ڷ  Լ(Proc Ǵ Lambda) args   ȣѴ.
+cell apply_proc(const cell& proc, const cells& args) {
+	if (proc.type == Proc) return call_proc(proc.proc, args);
+	if (proc.type == Lambda) {
+		scoped_frame frame(proc.env);
+		frame->rebind(proc.list[1].list, args);
+		return eval_body(proc.list, 2, frame.env);
+	}
+	return error;
+}
+// Լ  . FALSE, NIL,  Ʈ  .
+bool is_false(const cell& c) {
+	if (c.type == Symbol) return c.val == "FALSE" || c.val == "NIL";
+	return c.type == List && c.list.empty() && c.val.empty();
+}
+
+//////////////////////   Լ
+numvec* as_vec(const cell& c) { return c.type == Vector ? static_cast<numvec*>(c.obj) : 0; }
+cell vec_cell(numvec* v) {
+	cell result(Vector);
+	result.obj = v;
+	return result;
+}
+// i° Ҹ Number cell ش.
+cell vec_elem(const numvec* v, size_t i) {
+	if (v->is_float) return cell(Number, to_string(v->flts[i]));
+	return cell(Number, str(v->ints[i]));
+}
+// ʹ double ٲ 纻 tmp  ش. Ҽ ʹ   ״ .
+const double* vec_doubles(const numvec* v, vector<double>& tmp) {
+	if (v->is_float) return v->flts.data();
+	tmp.assign(v->ints.begin(), v->ints.end());
+	return tmp.data();
+}
+
+cell proc_vector(const cells& c) {//(VECTOR 1 2 3), (VECTOR '(1 2 3)), #(1 2 3)
+	const cells& elems = (c.size() == 1 && c[0].type == List) ? c[0].list : c;
+	for (cellit i = elems.begin(); i != elems.end(); ++i)
+		if (i->type != Number) return error;
+	numvec* v = new numvec(check_float(elems.begin(), elems.end()));
+	for (cellit i = elems.begin(); i != elems.end(); ++i) {
+		if (v->is_float) v->flts.push_back(atof(i->val.c_str()));
+		else v->ints.push_back(atoll(i->val.c_str()));
+	}
+	return vec_cell(v);
+}
+cell proc_make_vector(const cells& c) {//(MAKE-VECTOR ũ [ʱⰪ])
+	if (c.empty() || c[0].type != Number) return error;
+	long n = atol(c[0].val.c_str());
+	if (n < 0 || (c.size() > 1 && c[1].type != Number)) return error;
+	numvec* v = new numvec(c.size() > 1 && isfloat(c[1].val));
+	if (v->is_float) v->flts.assign(n, atof(c[1].val.c_str()));
+	else v->ints.assign(n, c.size() > 1 ? atoll(c[1].val.c_str()) : 0);
+	return vec_cell(v);
+}
+cell proc_vref(const cells& c) {//(VREF  ε)
+	numvec* v = as_vec(c[0]);
+	if (!v || c[1].type != Number) return error;
+	long i = atol(c[1].val.c_str());
+	if (i < 0 || i >= (long)v->size()) return error;
+	return vec_elem(v, i);
+}
+cell proc_vset(const cells& c) {//(VSET!  ε ) ͸  ٲ۴.
+	numvec* v = as_vec(c[0]);
+	if (!v || c[1].type != Number || c[2].type != Number) return error;
+	long i = atol(c[1].val.c_str());
+	if (i < 0 || i >= (long)v->size()) return error;
+	if (isfloat(c[2].val)) v->to_float();
+	if (v->is_float) v->flts[i] = atof(c[2].val.c_str());
+	else v->ints[i] = atoll(c[2].val.c_str());
+	return c[2];
+}
+
+//V+, V*   Һ .  ڸ  ̸ŭ ÷(broadcast) Ѵ.
+//ø   迭 ä. numvec  ϵǴ ü̹Ƿ ӽ÷ ų  ʴ´.
+cell vec_elementwise(const cells& c, bool mul) {
+	if (c.size() != 2 || (!as_vec(c[0]) && !as_vec(c[1]))) return error;
+	numvec* a = as_vec(c[0]);
+	numvec* b = as_vec(c[1]);
+	if ((!a && c[0].type != Number) || (!b && c[1].type != Number)) return error;
+	if (a && b && (a->size() != b->size() || (a->is_matrix() && b->is_matrix() && a->cols != b->cols))) return error;
+	size_t n = a ? a->size() : b->size();
+	const numvec* shape = a && (a->is_matrix() || !b) ? a : b;
+
+	numvec* r = new numvec(a ? a->is_float : isfloat(c[0].val));
+	if (b ? b->is_float : isfloat(c[1].val)) r->is_float = true;
+	r->rows = shape->rows;
+	r->cols = shape->cols;
+	if (r->is_float) {
+		auto doubles = [n](const numvec* v, const cell& s, vector<double>& tmp) {
+			if (v) return vec_doubles(v, tmp);
+			tmp.assign(n, atof(s.val.c_str()));
+			return (const double*)tmp.data();
+		};
+		vector<double> ta, tb;
+		const double* x = doubles(a, c[0], ta);
+		const double* y = doubles(b, c[1], tb);
+		r->flts.resize(n);
+		(mul ? kernels().mul_f : kernels().add_f)(x, y, r->flts.data(), n);
+	}
+	else {
+		auto ints = [n](const numvec* v, const cell& s, vector<long long>& tmp) {
+			if (v) return v->ints.data();
+			tmp.assign(n, atoll(s.val.c_str()));
+			return (const long long*)tmp.data();
+		};
+		vector<long long> ta, tb;
+		const long long* x = ints(a, c[0], ta);
+		const long long* y = ints(b, c[1], tb);
+		r->ints.resize(n);
+		for (size_t i = 0; i < n; i++) r->ints[i] = mul ? x[i] * y[i] : x[i] + y[i];
+	}
+	return vec_cell(r);
+}
+cell proc_vadd(const cells& c) { return vec_elementwise(c, false); }
+cell proc_vmul(const cells& c) { return vec_elementwise(c, true); }
+cell proc_vsum(const cells& c) {
+	numvec* v = as_vec(c[0]);
+	if (!v) return error;
+	if (v->is_float) return cell(Number, to_string(kernels().sum_f(v->flts.data(), v->size())));
+	return cell(Number, str(kernels().sum_i(v->ints.data(), v->size())));
+}
+cell proc_vdot(const cells& c) {
+	numvec* a = as_vec(c[0]);
+	numvec* b = as_vec(c[1]);
+	if (!a || !b || a->size() != b->size()) return error;
+	if (!a->is_float && !b->is_float) {
+		long long s = 0;
+		for (size_t i = 0; i < a->size(); i++) s += a->ints[i] * b->ints[i];
+		return cell(Number, str(s));
+	}
+	vector<double> ta, tb;
+	return cell(Number, to_string(kernels().dot_f(vec_doubles(a, ta), vec_doubles(b, tb), a->size())));
+}
+cell proc_vmin(const cells& c) {
+	numvec* v = as_vec(c[0]);
+	if (!v) return error;
+	if (v->size() == 0) return nil;
+	if (v->is_float) return cell(Number, to_string(kernels().min_f(v->flts.data(), v->size())));
+	return cell(Number, str(*min_element(v->ints.begin(), v->ints.end())));
+}
+cell proc_vmax(const cells& c) {
+	numvec* v = as_vec(c[0]);
+	if (!v) return error;
+	if (v->size() == 0) return nil;
+	if (v->is_float) return cell(Number, to_string(kernels().max_f(v->flts.data(), v->size())));
+	return cell(Number, str(*max_element(v->ints.begin(), v->ints.end())));
+}
+
+////////////////////// Ű 񱳿 ؽ
+//ڴ ڿ  ƴ϶  Ѵ. ("2.5" "2.500000"  )
+//str()  ó տ 0    ڰ ٸ  ٸ.
+bool plain_int(const string& s) {
+	return s.size() == 1 || (s[0] != '0' && (s[0] != '-' || s[1] != '0'));
+}
+bool number_eq(const cell& a, const cell& b) {
+	if (a.val == b.val) return true;
+	bool fa = isfloat(a.val);
+	if (fa != isfloat(b.val)) return false;
+	if (!fa && plain_int(a.val) && plain_int(b.val)) return false;
+	if (isfloat(a.val)) return atof(a.val.c_str()) == atof(b.val.c_str());
+	return atoll(a.val.c_str()) == atoll(b.val.c_str());
+}
+//EQ:  . ɺ ڿ ̸, ڴ    ,
+//Ʈ Լ,  ü  ( ü) ų  .
+bool cell_eq(const cell& a, const cell& b) {
+	if (a.type != b.type) return false;
+	switch (a.type) {
+	case Number: case Symbol: case String: return a.val == b.val;
+	case Proc: return a.proc == b.proc;
+	case Lambda: case Macro: return a.env == b.env && a.list.block() == b.list.block();
+	case List: return a.val == b.val && a.list.block() == b.list.block();
+	default: return a.obj == b.obj;
+	}
+}
+//EQL: EQ ,  (/Ҽ) ڴ  Ѵ. ("2.5" "2.500000"  )
+bool cell_eql(const cell& a, const cell& b) {
+	if (a.type == Number && b.type == Number) return number_eq(a, b);
+	return cell_eq(a, b);
+}
+//EQUAL: Ʈ  ϰ,  EQL .  Ʈ C++  ġ ʵ
+//  work ׾ư ݺ Ѵ.  Ҹ  Ʈ Ҹ  ʰ
+//ٰ Ѵ. ؽ ܽ ڸ   Ƿ '(1.0) '(1.00)ó Ұ ޶   ִ.
+bool cell_equal(const cell& a, const cell& b) {
+	if (a.type != List || b.type != List) return cell_eql(a, b);
+	thread_local vector<pair<const cell*, const cell*> > work;//ȣ⸶  Ҵ ʵ ٽ .
+	work.clear();
+	work.push_back(make_pair(&a, &b));
+	while (!work.empty()) {
+		const cell& x = *work.back().first;
+		const cell& y = *work.back().second;
+		work.pop_back();
+		if (x.val != y.val || x.list.size() != y.list.size()) return false;
+		const cell_block* bx = x.list.block(), *by = y.list.block();
+		if (bx == by) continue;
+		for (size_t i = 0; i < bx->items.size(); i++) {
+			const cell& p = bx->items[i], &q = by->items[i];
+			if (p.type == List && q.type == List) work.push_back(make_pair(&p, &q));
+			else if (!cell_eql(p, q)) return false;
+		}
+	}
+	return true;
+}
+cell proc_eq(const cells& c) { return cell_eq(c[0], c[1]) ? true_sym : false_sym; }
+cell proc_eql(const cells& c) { return cell_eql(c[0], c[1]) ? true_sym : false_sym; }
+cell proc_equal_deep(const cells& c) { return cell_equal(c[0], c[1]) ? true_sym : false_sym; }
+
+////////////////////// Ʈ ˻
+//:TEST   Լ.  ʾ EQL Ѵ.
+//EQ, EQL, EQUAL̸ Լ θ ʰ ٷ ϹǷ Ҹ Ҵϴ  .
+//direct ִٰ ؼ hashtable ãƵ Ǵ  ƴϴ. hashtable EQL(deep̸ EQUAL)θ ϹǷ,
+//ؽ÷ ã  ݵ hashable() , ̺ hash_deep() .
+struct cell_test {
+	cell_test(const cell& f) : direct(0), fn(f, 2) {
+		if (f.type == Lambda) return;//fn θ.
+		if (f.type != Proc || f.proc == proc_eql) direct = cell_eql;
+		else if (f.proc == proc_eq) direct = cell_eq;
+		else if (f.proc == proc_equal_deep) direct = cell_equal;
+	}
+	//hashtable ãƵ direct   . EQ EQL Ƿ ƴϴ.
+	bool hashable() const { return direct == cell_eql || direct == cell_equal; }
+	bool hash_deep() const { return direct == cell_equal; }
+	bool calls_function() const { return !direct; }//  :TEST Լ θ
+	bool operator()(const cell& a, const cell& b) {
+		if (direct) return direct(a, b);
+		fn.args[0] = a;
+		fn.args[1] = b;
+		return !is_false(fn.call());
+	}
+private:
+	bool(*direct)(const cell&, const cell&);
+	caller fn;
+};
+//c[from] :TEST Լ  ش.  nil(EQL)
+cell test_arg(const cells& c, size_t from) {
+	for (size_t i = from; i + 1 < c.size(); i += 2)
+		if (c[i].val == ":TEST") return c[i + 1];
+	return nil;
+}
+//(MEMBER  Ʈ [:TEST Լ]) Ҹ ã  Һ  Ʈ
+cell proc_member(const cells& c) {
+	cell_test test(test_arg(c, 2));
+	const cells& l = c[1].list;
+	for (size_t i = 0; i < l.size(); i++)
+		if (test(c[0], l[i])) {
+			if (i == 0) return c[1];
+			cell result(List);
+			result.list = cells(l.begin() + i, l.end());
+			return result;
+		}
+	return nil;
+}
+//(ASSOC Ű Ʈ [:TEST Լ])
+cell proc_assoc(const cells& c) {
+	cell_test test(test_arg(c, 2));
+	for (cellit i = c[1].list.begin(); i != c[1].list.end(); ++i)
+		if (!i->list.empty() && test(c[0], i->list[0])) return *i;
+	return nil;
+}
+//(REMOVE  Ʈ [:TEST Լ])
+cell proc_remove(const cells& c) {
+	cell_test test(test_arg(c, 2));
+	cells result;
+	for (cellit i = c[1].list.begin(); i != c[1].list.end(); ++i)
+		if (!test(c[0], *i)) result.push_back(*i);
+	if (result.size() == c[1].list.size()) return c[1];//   Ҹ ״ Բ .
+	if (result.empty()) return nil;
+	cell r(List);
+	r.list.swap(result);
+	return r;
+}
+//tree ȿ old    new_ ٲ۴. ٲ   κ Ʈ  Ҹ ״ .
+cell subst_tree(const cell& new_, const cell& old, const cell& tree, cell_test& test) {
+	if (test(old, tree)) return new_;
+	if (tree.type != List || tree.list.empty()) return tree;
+	cell result(tree);
+	for (size_t i = 0; i < tree.list.size(); i++) {
+		cell e = subst_tree(new_, old, tree.list[i], test);
+		if (!cell_eq(e, tree.list[i])) result.list[i] = e;
+	}
+	return result;
+}
+//(SUBST   Ʈ [:TEST Լ])  Ʈ ٲ۴.
+cell proc_subst(const cells& c) {
+	cell_test test(test_arg(c, 3));
+	return subst_tree(c[0], c[1], c[2], test);
+}
+
+//////////////////////  
+//Ʈ  . ã Ʈ ªų :TEST EQL/EQUAL ƴϸ ϳ Ȱ,
+// ۿ ؽ ̺ ־ ãǷ   ϴ ð .
+enum { SET_HASH_MIN = 16 };
+
+//Ұ Ʈ ȿ ִ  . 
+struct cell_set {
+	cell_test& test;
+	const cells& elems;
+	hashtable* table;
+
+	cell_set(cell_test& test, const cells& elems) : test(test), elems(elems), table(0) {
+		if (test.hashable() && elems.size() >= SET_HASH_MIN) {
+			table = new hashtable(test.hash_deep());
+			for (size_t i = 0; i < elems.size(); i++) table->put(elems[i], nil);
+		}
+	}
+	~cell_set() { delete table; }
+	bool contains(const cell& x) {
+		if (table) return table->find(x) != 0;
+		for (size_t i = 0; i < elems.size(); i++)
+			if (test(x, elems[i])) return true;
+		return false;
+	}
+};
+//ҵ Ʈ. ϳ  NIL
+cell set_result(cells& elems) {
+	if (elems.empty()) return nil;
+	cell result(List);
+	result.list.swap(elems);
+	return result;
+}
+//(UNION Ʈ1 Ʈ2 [:TEST Լ]) Ʈ1 ҵ ڿ Ʈ1  Ʈ2 ҵ δ.
+cell proc_union(const cells& c) {
+	cell_test test(test_arg(c, 2));
+	cell_set in1(test, c[0].list);
+	cells result(c[0].list);
+	for (cellit i = c[1].list.begin(); i != c[1].list.end(); ++i)
+		if (!in1.contains(*i)) result.push_back(*i);
+	return set_result(result);
+}
+//(INTERSECTION Ʈ1 Ʈ2 [:TEST Լ]) Ʈ2 ִ Ʈ1 ҵ. Ʈ1  .
+cell proc_intersection(const cells& c) {
+	cell_test test(test_arg(c, 2));
+	cell_set in2(test, c[1].list);
+	cells result;
+	for (cellit i = c[0].list.begin(); i != c[0].list.end(); ++i)
+		if (in2.contains(*i)) result.push_back(*i);
+	return set_result(result);
+}
+//(SET-DIFFERENCE Ʈ1 Ʈ2 [:TEST Լ]) Ʈ2  Ʈ1 ҵ. Ʈ1  .
+cell proc_set_difference(const cells& c) {
+	cell_test test(test_arg(c, 2));
+	cell_set in2(test, c[1].list);
+	cells result;
+	for (cellit i = c[0].list.begin(); i != c[0].list.end(); ++i)
+		if (!in2.contains(*i)) result.push_back(*i);
+	return set_result(result);
+}
+//(REMOVE-DUPLICATES Ʈ [:TEST Լ] [:FROM-END ])
+//Common Lispó  Ұ ̸   (:FROM-END ó  ),  ҵ  ״ д.
+cell proc_remove_duplicates(const cells& c) {
+	cell_test test(test_arg(c, 1));
+	bool from_end = false;
+	for (size_t i = 1; i + 1 < c.size(); i += 2)
+		if (c[i].val == ":FROM-END") from_end = !is_false(c[i + 1]);
+	const cells& l = c[0].list;
+	size_t n = l.size();
+	cells result;
+	vector<bool> keep(n, false);
+	bool hashed = test.hashable() && n >= SET_HASH_MIN;
+	hashtable seen(test.hash_deep());
+	for (size_t k = 0; k < n; k++) {
+		size_t i = from_end ? k : n - 1 - k;// ʺ ȴ´.
+		bool dup = false;
+		if (hashed) {
+			dup = seen.find(l[i]) != 0;
+			if (!dup) seen.put(l[i], nil);
+		}
+		else {
+			for (size_t j = 0; j < n && !dup; j++)
+				dup = keep[j] && test(l[i], l[j]);
+		}
+		keep[i] = !dup;
+	}
+	for (size_t i = 0; i < n; i++)
+		if (keep[i]) result.push_back(l[i]);
+	if (result.size() == n) return c[0];
+	return set_result(result);
+}
+//std::hash    ״ ֹǷ,  Ž翡 ӵ Ű  
+//ġ ʵ Ʈ  ش. (splitmix64  ܰ)
+size_t mix_hash(unsigned long long h) {
+	h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ULL;
+	h ^= h >> 27; h *= 0x94d049bb133111ebULL;
+	return (size_t)(h ^ (h >> 31));
+}
+size_t hash_cell(const cell& c, bool deep) {
+	return mix_hash(hash_raw(c, deep));
+}
+size_t hash_raw(const cell& c, bool deep) {
+	switch (c.type) {
+	case Number:
+		if (isfloat(c.val)) return std::hash<double>()(atof(c.val.c_str()));
+		return std::hash<long long>()(atoll(c.val.c_str()));
+	case Symbol: case String: return std::hash<string>()(c.val) ^ c.type;
+	case Proc: return std::hash<void*>()((void*)c.proc);
+	case Lambda: return std::hash<void*>()(c.env);
+	case List: {
+		if (!deep) return std::hash<const void*>()(c.list.block());//EQL   .
+		size_t h = c.list.size();
+		//FNVó  ؽø ʷ ´.
+		for (cellit i = c.list.begin(); i != c.list.end(); ++i) h = (h ^ hash_cell(*i, true)) * 1099511628211ULL;
+		return h;
+	}
+	default: return std::hash<void*>()(c.obj);
+	}
+}
+
+//ؽ ܽ. ο Ʈ   cons_table ־,   Ʈ  ϳ Բ .
+// Ʈ Ƿ,  Ұ    Ʈ  ּҸ ؼ   ִ.
+//ǥ(interpreter::cons_table) ͸ ϳ ְ,   ʴ Ʈ   ǥ .
+
+bool same_interned(const cell& a, const cell& b) {
+	if (a.type == List && b.type == List) return a.val == b.val && a.list.block() == b.list.block();
+	return cell_eq(a, b);
+}
+size_t interned_hash(const cells& items) {
+	size_t h = items.size();
+	for (size_t i = 0; i < items.size(); i++) {
+		const cell& c = items[i];
+		size_t e = c.type == List ? std::hash<const void*>()(c.list.block()) ^ std::hash<string>()(c.val) : hash_raw(c, false);
+		h = (h ^ mix_hash(e)) * 1099511628211ULL;
+	}
+	return h;
+}
+//c   Ʈ ؽ ̵ܽ ҷ ٲ۴.
+void hash_cons(cell& c) {
+	if (c.type != List || c.list.empty()) return;
+	if (c.list.block()->interned) return;
+	cells& items = c.list.mut();
+	for (size_t i = 0; i < items.size(); i++) hash_cons(items[i]);
+	size_t h = interned_hash(items);
+	auto& cons_table = interp().cons_table;
+	auto range = cons_table.equal_range(h);
+	for (auto i = range.first; i != range.second; ++i) {
+		const cells& other = i->second->items;
+		if (other.size() == items.size() && equal(items.begin(), items.end(), other.begin(), same_interned)) {
+			c.list.share(i->second);
+			return;
+		}
+	}
+	shared_ptr<cell_block> b = make_shared<cell_block>();
+	b->items.swap(items);
+	b->hash = h;
+	b->interned = true;
+	cons_table.insert(make_pair(h, b));
+	c.list.share(b);
+}
+cell proc_hash_cons(const cells& c) {//(HASH-CONS Ʈ)  ߿  Ʈ ؽ ܽѴ.
+	cell result(c[0]);
+	lock_guard<mutex> lock(interp().cons_lock);
+	hash_cons(result);
+	return result;
+}
+
+//OMAP Ű .  < ڿ < ɺ <    ̰,  
+//ڴ ũ, ڿ ɺ  , Ʈ Ҹ տ Ѵ.
+int type_rank(const cell& c) {
+	switch (c.type) {
+	case Number: return 0;
+	case String: return 1;
+	case Symbol: return 2;
+	case List: return 3;
+	default: return 4;
+	}
+}
+int compare_cells(const cell& a, const cell& b) {
+	int ra = type_rank(a), rb = type_rank(b);
+	if (ra != rb) return ra < rb ? -1 : 1;
+	switch (a.type) {
+	case Number:
+		if (!isfloat(a.val) && !isfloat(b.val)) {
+			long long x = atoll(a.val.c_str()), y = atoll(b.val.c_str());
+			return x < y ? -1 : (x > y ? 1 : 0);
+		}
+		else {
+			double x = atof(a.val.c_str()), y = atof(b.val.c_str());
+			return x < y ? -1 : (x > y ? 1 : 0);
+		}
+	case String: case Symbol: return a.val.compare(b.val) < 0 ? -1 : (a.val == b.val ? 0 : 1);
+	case List:
+		for (size_t i = 0; i < a.list.size() && i < b.list.size(); i++) {
+			int r = compare_cells(a.list[i], b.list[i]);
+			if (r) return r;
+		}
+		return a.list.size() < b.list.size() ? -1 : (a.list.size() > b.list.size() ? 1 : 0);
+	default: {
+		const void* x = a.obj ? (const void*)a.obj : (const void*)a.env;
+		const void* y = b.obj ? (const void*)b.obj : (const void*)b.env;
+		return x < y ? -1 : (x > y ? 1 : 0);
+	}
+	}
+}
+//compare_cells   8Ʈ .  ٸ װ͸  .
+void key_summary(const cell& c, unsigned char& rank, unsigned long long& pre) {
+	rank = (unsigned char)type_rank(c);
+	pre = 0;
+	if (c.type == Number) {
+		double d = atof(c.val.c_str());
+		if (d == 0) d = 0;//-0.0 0.0  Ű
+		memcpy(&pre, &d, sizeof pre);
+		pre = (pre >> 63) ? ~pre : pre | (1ULL << 63);//  Ʈ,  ȣ Ʈ  ȣ    ȴ.
+	}
+	else if (c.type == String || c.type == Symbol) {
+		for (size_t i = 0; i < 8; i++)
+			pre = (pre << 8) | (i < c.val.size() ? (unsigned char)c.val[i] : 0);
+	}
+}
+
+//////////////////////  ִ  Լ
+omap* as_omap(const cell& c) { return c.type == OMap ? static_cast<omap*>(c.obj) : 0; }
+cell pair_cell(const cell& key, const cell& val) {
+	cell result(List);
+	result.list.push_back(key);
+	result.list.push_back(val);
+	return result;
+}
+
+cell proc_make_omap(const cells&) {
+	cell result(OMap);
+	result.obj = new omap();
+	return result;
+}
+cell proc_omap_put(const cells& c) {//(OMAP-PUT  Ű )
+	omap* m = as_omap(c[0]);
+	if (!m) return error;
+	m->put(c[1], c[2]);
+	return c[2];
+}
+cell proc_omap_get(const cells& c) {//(OMAP-GET  Ű [⺻])
+	omap* m = as_omap(c[0]);
+	if (!m) return error;
+	cell* v = m->get(c[1]);
+	if (v) return *v;
+	return c.size() > 2 ? c[2] : nil;
+}
+cell proc_omap_remove(const cells& c) {
+	omap* m = as_omap(c[0]);
+	if (!m) return error;
+	return m->remove(c[1]) ? true_sym : false_sym;
+}
+cell proc_omap_count(const cells& c) {
+	omap* m = as_omap(c[0]);
+	if (!m) return error;
+	return cell(Number, str((long long)m->root->size));
+}
+//(OMAP-NTH  i)  ʺ i° (Ű ). (OMAP-NTH  0) ּڰ
+cell proc_omap_nth(const cells& c) {
+	omap* m = as_omap(c[0]);
+	if (!m || c[1].type != Number) return error;
+	long i = atol(c[1].val.c_str());
+	int pos;
+	const bnode* leaf = i < 0 ? 0 : m->select(i, pos);
+	if (!leaf) return nil;
+	return pair_cell(leaf->keys[pos], leaf->vals[pos]);
+}
+cell proc_omap_min(const cells& c) {
+	omap* m = as_omap(c[0]);
+	if (!m) return error;
+	return proc_omap_nth(cells{ c[0], cell(Number, "0") });
+}
+cell proc_omap_max(const cells& c) {
+	omap* m = as_omap(c[0]);
+	if (!m) return error;
+	return proc_omap_nth(cells{ c[0], cell(Number, str((long long)m->root->size - 1)) });
+}
+cell proc_omap_rank(const cells& c) {//(OMAP-RANK  Ű) Ű  Ű 
+	omap* m = as_omap(c[0]);
+	if (!m) return error;
+	return cell(Number, str((long long)m->rank_of(c[1])));
+}
+//(OMAP-RANGE  [lo [hi]]) lo ̻ hi ̸ Ű ʷ  ݺ
+cell proc_omap_range(const cells& c) {
+	omap* m = as_omap(c[0]);
+	if (!m) return error;
+	omap_iter* it = new omap_iter(m);
+	if (c.size() > 1) {
+		it->has_lo = true;
+		it->lo = c[1];
+	}
+	it->seek();
+	if (c.size() > 2) {
+		it->has_hi = true;
+		it->hi = c[2];
+	}
+	cell result(Iterator);
+	result.obj = it;
+	return result;
+}
+cell proc_omap_next(const cells& c) {// (Ű ),  NIL
+	if (c[0].type != Iterator) return error;
+	cell result;
+	if (!static_cast<stream*>(c[0].obj)->next(result)) return nil;
+	return result;
+}
+
+////////////////////// ؽ ̺ Լ
+hashtable* as_hash(const cell& c) { return c.type == Hash ? static_cast<hashtable*>(c.obj) : 0; }
+
+cell proc_make_hash_table(const cells& c) {//(MAKE-HASH-TABLE [:TEST 'EQ|'EQL|'EQUAL])
+	bool deep = false;
+	for (size_t i = 0; i + 1 < c.size(); i += 2) {
+		if (c[i].val != ":TEST") return error;
+		if (c[i + 1].val == "EQUAL") deep = true;
+		else if (c[i + 1].val != "EQ" && c[i + 1].val != "EQL") return error;
+	}
+	cell result(Hash);
+	result.obj = new hashtable(deep);
+	return result;
+}
+cell proc_gethash(const cells& c) {//(GETHASH Ű ̺ [⺻])
+	hashtable* h = as_hash(c[1]);
+	if (!h) return error;
+	hashtable::entry* e = h->find(c[0]);
+	if (e) return e->value;
+	return c.size() > 2 ? c[2] : nil;
+}
+cell proc_sethash(const cells& c) {//(SETHASH Ű ̺ )
+	hashtable* h = as_hash(c[1]);
+	if (!h) return error;
+	h->put(c[0], c[2]);
+	return c[2];
+}
+cell proc_remhash(const cells& c) {//(REMHASH Ű ̺)
+	hashtable* h = as_hash(c[1]);
+	if (!h) return error;
+	return h->remove(c[0]) ? true_sym : false_sym;
+}
+cell proc_hash_count(const cells& c) {
+	hashtable* h = as_hash(c[0]);
+	if (!h) return error;
+	return cell(Number, str((long long)h->count));
+}
+cell proc_clrhash(const cells& c) {
+	hashtable* h = as_hash(c[0]);
+	if (!h) return error;
+	h->clear();
+	return c[0];
+}
+//  (Ű )   Ʈ
+cell proc_hash_pairs(const cells& c) {
+	hashtable* h = as_hash(c[0]);
+	if (!h) return error;
+	cell result(List);
+	for (size_t i = 0; i < h->entries.size(); i++) {
+		if (!h->entries[i].live) continue;
+		cell pair(List);
+		pair.list.push_back(h->entries[i].key);
+		pair.list.push_back(h->entries[i].value);
+		result.list.push_back(pair);
+	}
+	return result;
+}
+cell proc_hash_keys(const cells& c) {
+	hashtable* h = as_hash(c[0]);
+	if (!h) return error;
+	cell result(List);
+	for (size_t i = 0; i < h->entries.size(); i++)
+		if (h->entries[i].live) result.list.push_back(h->entries[i].key);
+	return result;
+}
+cell proc_hash_values(const cells& c) {
+	hashtable* h = as_hash(c[0]);
+	if (!h) return error;
+	cell result(List);
+	for (size_t i = 0; i < h->entries.size(); i++)
+		if (h->entries[i].live) result.list.push_back(h->entries[i].value);
+	return result;
+}
+//(MAPHASH Լ ̺)  ׸񸶴 (Լ Ű ) ȣѴ.
+//Լ ̺ ٲ  Ƿ ׸  ̸ صΰ ȣ .
+cell proc_maphash(const cells& c) {
+	hashtable* h = as_hash(c[1]);
+	if (!h) return error;
+	size_t n = h->entries.size();
+	caller f(c[0], 2);
+	for (size_t i = 0; i < n && i < h->entries.size(); i++) {
+		if (!h->entries[i].live) continue;
+		f.args[0] = h->entries[i].key;
+		f.args[1] = h->entries[i].value;
+		f.call();
+	}
+	return nil;
+}
+
+//////////////////////  Լ
+const size_t MAT_BLOCK_I = 64;//İ  ũ. B BK x BJ (256KB) L2 ĳÿ  Ҵ.
+const size_t MAT_BLOCK_K = 128;
+const size_t MAT_BLOCK_J = 256;
+const size_t MAT_PARALLEL_GRAIN = 1 << 16;//(Ǵ )  ̺    
+
+cell proc_make_matrix(const cells& c) {//(MAKE-MATRIX   [ʱⰪ])
+	if (c.size() < 2 || c[0].type != Number || c[1].type != Number) return error;
+	long rows = atol(c[0].val.c_str()), cols = atol(c[1].val.c_str());
+	if (rows <= 0 || cols <= 0) return error;
+	cells args(1, cell(Number, str((long long)rows * cols)));
+	if (c.size() > 2) args.push_back(c[2]);
+	cell result = proc_make_vector(args);
+	if (result.type != Vector) return error;
+	as_vec(result)->rows = rows;
+	as_vec(result)->cols = cols;
+	return result;
+}
+cell proc_matrix(const cells& c) {//(MATRIX '((1 2) (3 4))) ø Ʈ ķ ٲ۴.
+	const cells& rows = c[0].list;
+	if (c[0].type != List || rows.empty() || rows[0].list.empty()) return error;
+	cells flat;
+	for (cellit r = rows.begin(); r != rows.end(); ++r) {
+		if (r->list.size() != rows[0].list.size()) return error;
+		flat.insert(flat.end(), r->list.begin(), r->list.end());
+	}
+	cell result = proc_vector(flat);
+	if (result.type != Vector) return error;
+	as_vec(result)->rows = rows.size();
+	as_vec(result)->cols = rows[0].list.size();
+	return result;
+}
+cell proc_mref(const cells& c) {//(MREF  i j)
+	numvec* m = as_vec(c[0]);
+	if (!m || !m->is_matrix() || c[1].type != Number || c[2].type != Number) return error;
+	long i = atol(c[1].val.c_str()), j = atol(c[2].val.c_str());
+	if (i < 0 || j < 0 || i >= (long)m->rows || j >= (long)m->cols) return error;
+	return vec_elem(m, i * m->cols + j);
+}
+cell proc_mset(const cells& c) {//(MSET!  i j )
+	numvec* m = as_vec(c[0]);
+	if (!m || !m->is_matrix() || c[1].type != Number || c[2].type != Number) return error;
+	long i = atol(c[1].val.c_str()), j = atol(c[2].val.c_str());
+	if (i < 0 || j < 0 || i >= (long)m->rows || j >= (long)m->cols) return error;
+	return proc_vset(cells{ c[0], cell(Number, str((long long)(i * m->cols + j))), c[3] });
+}
+
+//C(m x n) += A(m x k) * B(k x n)  A [i0, i1) ุ Ѵ.
+//k, j    B  ĳÿ  ִ  A   ǰ ϰ,
+//   C  ࿡ B   ϴ axpy SIMD Ŀ ״ .
+void matmul_rows(const double* A, const double* B, double* C, size_t k, size_t n, size_t i0, size_t i1) {
+	const simd_table& kt = kernels();
+	for (size_t kk = 0; kk < k; kk += MAT_BLOCK_K) {
+		size_t k1 = min(k, kk + MAT_BLOCK_K);
+		for (size_t jj = 0; jj < n; jj += MAT_BLOCK_J) {
+			size_t jn = min(n, jj + MAT_BLOCK_J) - jj;
+			for (size_t ii = i0; ii < i1; ii += MAT_BLOCK_I) {
+				size_t iend = min(i1, ii + MAT_BLOCK_I);
+				for (size_t i = ii; i < iend; i++)
+					for (size_t p = kk; p < k1; p++)
+						kt.axpy_f(A[i * k + p], B + p * n + jj, C + i * n + jj, jn);
+			}
+		}
+	}
+}
+cell proc_matmul(const cells& c) {//(MATMUL A B) B 1 ͸ ͷ .
+	numvec* a = as_vec(c[0]);
+	numvec* b = as_vec(c[1]);
+	if (!a || !b || !a->is_matrix()) return error;
+	size_t m = a->rows, k = a->cols, n = b->is_matrix() ? b->cols : 1;
+	if ((b->is_matrix() ? b->rows : b->size()) != k) return error;
+
+	vector<double> ta, tb;
+	const double* A = vec_doubles(a, ta);
+	const double* B = vec_doubles(b, tb);
+	vector<double> C(m * n, 0.0);
+	size_t grain = max((size_t)1, MAT_PARALLEL_GRAIN / max((size_t)1, k * n));// ϳ  ּ  
+	parallel_for(m, grain, [&](size_t i0, size_t i1) { matmul_rows(A, B, C.data(), k, n, i0, i1); });
+
+	numvec* r = new numvec(a->is_float || b->is_float);
+	if (r->is_float) r->flts.swap(C);
+	else for (size_t i = 0; i < C.size(); i++) r->ints.push_back(llround(C[i]));
+	if (b->is_matrix()) {
+		r->rows = m;
+		r->cols = n;
+	}
+	return vec_cell(r);
+}
+//32 x 32 Ÿ  Űܼ б/   ĳ    Ѵ.
+template <class T>
+void transpose_into(const T* src, T* dst, size_t rows, size_t cols) {
+	const size_t tile = 32;
+	parallel_for((rows + tile - 1) / tile, max((size_t)1, MAT_PARALLEL_GRAIN / max((size_t)1, tile * cols)), [&](size_t t0, size_t t1) {
+		for (size_t ii = t0 * tile; ii < min(rows, t1 * tile); ii += tile)
+			for (size_t jj = 0; jj < cols; jj += tile)
+				for (size_t i = ii; i < min(rows, ii + tile); i++)
+					for (size_t j = jj; j < min(cols, jj + tile); j++)
+						dst[j * rows + i] = src[i * cols + j];
+	});
+}
+cell proc_transpose(const cells& c) {
+	numvec* a = as_vec(c[0]);
+	if (!a) return error;
+	size_t rows = a->is_matrix() ? a->rows : 1, cols = a->is_matrix() ? a->cols : a->size();
+	numvec* r = new numvec(a->is_float);
+	if (a->is_float) {
+		r->flts.resize(a->size());
+		transpose_into(a->flts.data(), r->flts.data(), rows, cols);
+	}
+	else {
+		r->ints.resize(a->size());
+		transpose_into(a->ints.data(), r->ints.data(), rows, cols);
+	}
+	r->rows = cols;
+	r->cols = rows;
+	return vec_cell(r);
+}
+//(SOLVE A B) κ ǹ LU ط A X = B Ǭ. B ͳ . A Ư̸ ERROR.
+cell proc_solve(const cells& c) {
+	numvec* a = as_vec(c[0]);
+	numvec* b = as_vec(c[1]);
+	if (!a || !b || !a->is_matrix() || a->rows != a->cols) return error;
+	size_t n = a->rows, nrhs = b->is_matrix() ? b->cols : 1;
+	if ((b->is_matrix() ? b->rows : b->size()) != n) return error;
+
+	vector<double> LU, X;
+	vec_doubles(a, LU);
+	if (a->is_float) LU = a->flts;//ϸ鼭 Ƿ ׻ 纻 .
+	vec_doubles(b, X);
+	if (b->is_float) X = b->flts;
+	vector<size_t> piv(n);
+
+	const simd_table& kt = kernels();
+	for (size_t k = 0; k < n; k++) {
+		size_t p = k;
+		for (size_t i = k + 1; i < n; i++)
+			if (fabs(LU[i * n + k]) > fabs(LU[p * n + k])) p = i;
+		if (fabs(LU[p * n + k]) < 1e-12) return error;
+		if (p != k) {
+			swap_ranges(LU.begin() + k * n, LU.begin() + (k + 1) * n, LU.begin() + p * n);
+			swap_ranges(X.begin() + k * nrhs, X.begin() + (k + 1) * nrhs, X.begin() + p * nrhs);
+		}
+		//k°  Ʒ    ̹Ƿ, ũ  Ѵ.
+		size_t rest = n - k - 1;
+		parallel_for(rest, max((size_t)1, MAT_PARALLEL_GRAIN / max((size_t)1, rest)), [&](size_t r0, size_t r1) {
+			for (size_t i = k + 1 + r0; i < k + 1 + r1; i++) {
+				double f = LU[i * n + k] / LU[k * n + k];
+				LU[i * n + k] = f;
+				kt.axpy_f(-f, &LU[k * n + k + 1], &LU[i * n + k + 1], rest);
+				kt.axpy_f(-f, &X[k * nrhs], &X[i * nrhs], nrhs);
+			}
+		});
+	}
+	for (size_t k = n; k-- > 0;) {//ڿ (U x = y)
+		for (size_t j = k + 1; j < n; j++)
+			kt.axpy_f(-LU[k * n + j], &X[j * nrhs], &X[k * nrhs], nrhs);
+		for (size_t r = 0; r < nrhs; r++) X[k * nrhs + r] /= LU[k * n + k];
+	}
+
+	numvec* r = new numvec(true);
+	r->flts.swap(X);
+	if (b->is_matrix()) {
+		r->rows = n;
+		r->cols = nrhs;
+	}
+	return vec_cell(r);
+}
+
+
+
+//////////////////////  Լ
+//Ʈ(Ǵ  ) ҵ. NIL  Ʈ
+const cells& seq_elems(const cell& c, cells& tmp) {
+	numvec* v = as_vec(c);
+	if (!v) return c.list;
+	tmp.clear();
+	for (size_t i = 0; i < v->size(); i++) tmp.push_back(vec_elem(v, i));
+	return tmp;
+}
+cell list_cell(cells& elems) {
+	if (elems.empty()) return nil;
+	cell result(List);
+	result.list.swap(elems);
+	return result;
+}
+
+cell proc_funcall(const cells& c) {//(FUNCALL Լ ...)
+	return apply_proc(c[0], cells(c.begin() + 1, c.end()));
+}
+cell proc_apply(const cells& c) {//(APPLY Լ ... Ʈ)  Ʈ Ǯ ڷ ѱ.
+	if (c.size() < 2) return error;
+	cells args(c.begin() + 1, c.end() - 1);
+	cells tmp;
+	const cells& rest = seq_elems(c.back(), tmp);
+	args.insert(args.end(), rest.begin(), rest.end());
+	return apply_proc(c[0], args);
+}
+//(MAPCAR Լ Ʈ...) Ʈ i° ҵ Լ θ  Ʈ.  ª Ʈ .
+cell proc_mapcar(const cells& c) {
+	if (c.size() < 2) return error;
+	size_t nseq = c.size() - 1, n = (size_t)-1;
+	vector<cells> tmp(nseq);
+	vector<const cells*> seqs(nseq);
+	for (size_t s = 0; s < nseq; s++) {
+		seqs[s] = &seq_elems(c[s + 1], tmp[s]);
+		n = min(n, seqs[s]->size());
+	}
+	caller f(c[0], nseq);
+	cells result;
+	result.reserve(n);
+	for (size_t i = 0; i < n; i++) {
+		for (size_t s = 0; s < nseq; s++) f.args[s] = (*seqs[s])[i];
+		result.push_back(f.call());
+	}
+	return list_cell(result);
+}
+//(REDUCE Լ Ʈ [:INITIAL-VALUE ʱⰪ]) ʺ   ´.
+cell reduce_stream(const cells& c);
+cell proc_reduce(const cells& c) {
+	if (c.size() < 2) return error;
+	if (c[1].type == Iterator) return reduce_stream(c);
+	cells tmp;
+	const cells& elems = seq_elems(c[1], tmp);
+	bool has_init = false;
+	cell acc;
+	for (size_t i = 2; i + 1 < c.size(); i += 2) {
+		if (c[i].val != ":INITIAL-VALUE") return error;
+		acc = c[i + 1];
+		has_init = true;
+	}
+	if (!has_init && elems.empty()) return apply_proc(c[0], cells());//(REDUCE #'+ NIL) => (+) => 0
+	size_t i = 0;
+	if (!has_init) acc = elems[i++];
+	caller f(c[0], 2);
+	for (; i < elems.size(); i++) {
+		f.args[0] = std::move(acc);// Ʈ  ʰ ѱ.
+		f.args[1] = elems[i];
+		acc = f.call();
+	}
+	return acc;
+}
+//////////////////////  Լ
+// ϳ ϴ  Ƿ,  PAR_GRAIN Դ  ʴ´.
+enum { PAR_GRAIN = 64 };
+//c  :GRAIN   n ٿ   ,  PAR_GRAIN ش.
+size_t grain_arg(const cells& c, size_t& n) {
+	if (n >= 2 && c[n - 2].val == ":GRAIN" && c[n - 1].type == Number) {
+		n -= 2;
+		return (size_t)max(1LL, atoll(c[n + 1].val.c_str()));
+	}
+	return PAR_GRAIN;
+}
+//(PMAP Լ Ʈ... [:GRAIN ]) MAPCAR  ҵ  忡  Ѵ.
+//Լ ۿ  Ѵ.   MAPCAR .
+cell proc_pmap(const cells& c) {
+	size_t argc = c.size(), grain = grain_arg(c, argc);
+	if (argc < 2) return error;
+	size_t nseq = argc - 1, n = (size_t)-1;
+	vector<cells> tmp(nseq);
+	vector<const cells*> seqs(nseq);
+	for (size_t s = 0; s < nseq; s++) {
+		seqs[s] = &seq_elems(c[s + 1], tmp[s]);
+		n = min(n, seqs[s]->size());
+	}
+	cells result(n);
+	parallel_for(n, grain, [&](size_t i0, size_t i1) {
+		caller f(c[0], nseq);
+		for (size_t i = i0; i < i1; i++) {
+			for (size_t s = 0; s < nseq; s++) f.args[s] = (*seqs[s])[i];
+			result[i] = f.call();
+		}
+	});
+	return list_cell(result);
+}
+//(PREDUCE Լ Ʈ [:INITIAL-VALUE ʱⰪ] [:GRAIN ])    ,   ʺ ´.
+//Լ չĢ ϸ(+, *, MAX, APPEND ) REDUCE  .
+cell proc_preduce(const cells& c) {
+	size_t argc = c.size(), grain = grain_arg(c, argc);
+	if (argc != 2 && !(argc == 4 && c[2].val == ":INITIAL-VALUE")) return error;
+	cells tmp;
+	const cells& elems = seq_elems(c[1], tmp);
+	if (elems.empty()) return argc == 4 ? c[3] : apply_proc(c[0], cells());
+	vector<pair<size_t, cell> > parts;//( ,    )
+	mutex parts_lock;
+	parallel_for(elems.size(), grain, [&](size_t i0, size_t i1) {
+		caller f(c[0], 2);
+		cell acc = elems[i0];
+		for (size_t i = i0 + 1; i < i1; i++) {
+			f.args[0] = std::move(acc);
+			f.args[1] = elems[i];
+			acc = f.call();
+		}
+		lock_guard<mutex> lock(parts_lock);
+		parts.push_back(make_pair(i0, acc));
+	});
+	sort(parts.begin(), parts.end(), [](const pair<size_t, cell>& a, const pair<size_t, cell>& b) { return a.first < b.first; });
+	caller f(c[0], 2);
+	size_t i = 0;
+	cell acc = argc == 4 ? c[3] : parts[i++].second;
+	for (; i < parts.size(); i++) {
+		f.args[0] = std::move(acc);
+		f.args[1] = parts[i].second;
+		acc = f.call();
+	}
+	return acc;
+}
+// (keep == true) Ǵ (keep == false) Ҹ .
+cell filter_cells(const cells& c, bool keep) {
+	if (c.size() < 2) return error;
+	cells tmp;
+	const cells& elems = seq_elems(c[1], tmp);
+	caller f(c[0], 1);
+	cells result;
+	for (cellit i = elems.begin(); i != elems.end(); ++i) {
+		f.args[0] = *i;
+		if (is_false(f.call()) != keep) result.push_back(*i);
+	}
+	return list_cell(result);
+}
+cell proc_remove_if(const cells& c) { return filter_cells(c, false); }
+cell proc_remove_if_not(const cells& c) { return filter_cells(c, true); }
+//EVERY: ϳ ̸ FALSE. SOME: ó   ,  NIL
+cell every_some(const cells& c, bool every) {
+	if (c.size() < 2) return error;
+	size_t nseq = c.size() - 1, n = (size_t)-1;
+	vector<cells> tmp(nseq);
+	vector<const cells*> seqs(nseq);
+	for (size_t s = 0; s < nseq; s++) {
+		seqs[s] = &seq_elems(c[s + 1], tmp[s]);
+		n = min(n, seqs[s]->size());
+	}
+	caller f(c[0], nseq);
+	for (size_t i = 0; i < n; i++) {
+		for (size_t s = 0; s < nseq; s++) f.args[s] = (*seqs[s])[i];
+		cell r = f.call();
+		if (every && is_false(r)) return false_sym;
+		if (!every && !is_false(r)) return r;
+	}
+	return every ? true_sym : nil;
+}
+cell proc_every(const cells& c) { return every_some(c, true); }
+cell proc_some(const cells& c) { return every_some(c, false); }
+
+//////////////////////  
+//DELAY  (promise). ó FORCE    ϰ  Ѵ.
+struct promise : object {
+	cell expr;
+	environment* env;
+	bool forced;
+	cell value;
+	promise(const cell& expr, environment* env) : expr(expr), env(env), forced(false) {}
+	void trace(gc_marker& m) const {
+		m.mark(expr);
+		m.mark(env);
+		m.mark(value);
+	}
+};
+cell proc_force(const cells& c) {
+	if (c[0].type != Promise) return c[0];// ƴϸ   ״
+	promise* p = static_cast<promise*>(c[0].obj);
+	if (!p->forced) {
+		p->value = eval(p->expr, p->env);
+		p->forced = true;
+		p->expr = cell();
+	}
+	return p->value;
+}
+
+//(FUTURE )  ڸǥ.  ϲ 忡 ȴ.
+// ƹ  ʾ TOUCH 尡  ϹǷ, ϲ  ٺ(Ǵ ھ ϳ)  ʴ´.
+struct future_value : object {
+	cell expr;
+	environment* env;
+	atomic<int> state;//0:  , 1:  , 2: 
+	atomic<bool> queued;//۾ Ǯ    ü Ų.
+	cell value;
+	mutex lock;
+	condition_variable done;
+
+	future_value(const cell& expr, environment* env) : expr(expr), env(env), state(0), queued(true) {}
+	void trace(gc_marker& m) const {
+		m.mark(expr);
+		m.mark(env);
+		m.mark(value);
+	}
+	bool pinned() const { return queued.load(); }
+	bool claim() {
+		int expected = 0;
+		if (!state.compare_exchange_strong(expected, 1)) return false;
+		if (heap) heap->enter();
+		return true;
+	}
+	void run() {
+		gc_heap* h = heap;
+		value = eval(expr, env);
+		expr = cell();
+		{
+			lock_guard<mutex> guard(lock);
+			state.store(2);
+		}
+		done.notify_all();
+		if (h) h->leave();
+	}
+	const cell& touch() {
+		if (claim()) run();
+		else if (state.load() != 2) {
+			unique_lock<mutex> guard(lock);
+			done.wait(guard, [this] { return state.load() == 2; });
+		}
+		return value;
+	}
+};
+cell make_future(const cell& expr, environment* env) {
+	future_value* f = new future_value(expr, env);
+	env->capture();
+	interpreter* owner = current_interpreter;
+	work_pool::get().submit([f, owner] {
+		interpreter_scope scope(owner);
+		if (f->claim()) f->run();
+		f->queued.store(false);
+	});
+	cell result(Future);
+	result.obj = f;
+	return result;
+}
+//Future    ٷ  , ƴϸ c ״ ش.
+const cell& touch(const cell& c) {
+	return c.type == Future ? static_cast<future_value*>(c.obj)->touch() : c;
+}
+cell proc_touch(const cells& c) { return touch(c[0]); }
+
+////////////////////// ׸ 
+//(SPAWN ...)   . 帶     ,   ϲ OS 尡  Ѵ.
+//eval GREEN_FUEL θ  Ƿ(),   尡 ϲ  ʴ´.
+// ó  ϲۿ . ٸ ϲ Ű  thread_local(frame_pool ) ڼ̱ ̴.
+// mmap Ƿ   ŭ ޸𸮸 Ѵ. 1MB  ȣ õ ܰ .
+enum { GREEN_STACK = 1024 * 1024, GREEN_FUEL = 10000, GREEN_WORKERS = 4 };
+
+#ifdef GREEN_ASM
+//callee-saved Ϳ mxcsr, x87  带 ÿ ְ  ͸ ٲ۴. ý ȣ .
+extern "C" void green_switch(void** save_sp, void* to_sp);
+extern "C" void green_start();
+asm(R"(
+	.text
+	.globl green_switch
+	.type green_switch, @function
+green_switch:
+	pushq %rbp
+	pushq %rbx
+	pushq %r12
+	pushq %r13
+	pushq %r14
+	pushq %r15
+	subq $8, %rsp
+	stmxcsr (%rsp)
+	fnstcw 4(%rsp)
+	movq %rsp, (%rdi)
+	movq %rsi, %rsp
+	ldmxcsr (%rsp)
+	fldcw 4(%rsp)
+	addq $8, %rsp
+	popq %r15
+	popq %r14
+	popq %r13
+	popq %r12
+	popq %rbx
+	popq %rbp
+	ret
+	.size green_switch, .-green_switch
+	.globl green_start
+	.type green_start, @function
+green_start:
+	movq %r12, %rdi
+	callq *%r13
+	ud2
+	.size green_start, .-green_start
+)");
+struct green_context {
+	void* sp;
+	green_context() : sp(0) {}
+	// ÿ ó ȯ  green_start fn(arg) θ, green_switch   ׾ д.
+	void make(char* stack, size_t size, void (*fn)(void*), void* arg) {
+		void** top = (void**)(((uintptr_t)(stack + size)) & ~(uintptr_t)15);
+		*--top = (void*)green_start;//ret   16Ʈ ĵǰ, call fn ABI 8ŭ ߳ ä Ѵ.
+		*--top = 0;//rbp
+		*--top = 0;//rbx
+		*--top = arg;//r12
+		*--top = (void*)fn;//r13
+		*--top = 0;//r14
+		*--top = 0;//r15
+		unsigned int csr[2];
+		__asm__("stmxcsr %0" : "=m"(csr[0]));
+		__asm__("fnstcw %0" : "=m"(csr[1]));
+		void* saved;
+		memcpy(&saved, csr, sizeof saved);
+		*--top = saved;
+		sp = top;
+	}
+	void switch_to(green_context& to) { green_switch(&sp, to.sp); }
+};
+#elif defined(GREEN_UCONTEXT)
+struct green_context {
+	ucontext_t uc;
+	void make(char* stack, size_t size, void (*fn)(void*), void* arg) {
+		getcontext(&uc);
+		uc.uc_stack.ss_sp = stack;
+		uc.uc_stack.ss_size = size;
+		uc.uc_link = 0;
+		makecontext(&uc, (void (*)())fn, 1, arg);// ϳ κ ÷ int  ڸ Ѿ.
+	}
+	void switch_to(green_context& to) { swapcontext(&uc, &to.uc); }
+};
+#endif
+
+struct green_worker;
+struct stm_tx;
+struct green_thread : object {
+	enum state_t { Ready, Yielded, Sleeping, Parked, Done };
+	cell body;
+	environment* env;
+	interpreter* owner;
+	green_worker* home;
+	char* stack;
+	state_t state;
+	bool finished;//Done Ǿ    true. lock  д´.
+	cell value;
+	chrono::steady_clock::time_point wake;
+	vector<green_thread*> joiners;//JOINϸ ٸ ׸ 
+	mutex lock;
+	condition_variable done;//JOINϸ ٸ OS 
+	stm_tx* tx;// ִ  þ δ Ʈ
+#if defined(GREEN_ASM) || defined(GREEN_UCONTEXT)
+	green_context ctx;
+#endif
+	green_thread(const cell& body, environment* env)
+		: body(body), env(env), owner(current_interpreter), home(0), stack(0), state(Ready), finished(false), tx(0) {}
+	void trace(gc_marker& m) const {
+		m.mark(body);
+		m.mark(env);
+		m.mark(value);
+	}
+};
+thread_local green_thread* current_green = 0;
+thread_local long green_fuel = 0;//0̸ ׸  ̹Ƿ  ʴ´.
+thread_local stm_tx* current_tx = 0;// 尡  ϴ Ʈ(ATOMICALLY). ׸    ì .
+
+#if defined(GREEN_ASM) || defined(GREEN_UCONTEXT)
+//ϲ OS  ϳ. ڱ⿡ ð ׸ 鸸 .
+struct green_worker {
+	struct later {
+		bool operator()(const green_thread* a, const green_thread* b) const { return a->wake > b->wake; }
+	};
+	mutex lock;
+	condition_variable wake;
+	deque<green_thread*> ready;
+	priority_queue<green_thread*, vector<green_thread*>, later> sleeping;
+	green_context sched;//ϲ  ڽ 
+	atomic<size_t> load;// ׸  
+
+	green_worker() : load(0) { thread(&green_worker::loop, this).detach(); }
+	void make_ready(green_thread* g) {
+		{
+			lock_guard<mutex> guard(lock);
+			ready.push_back(g);
+		}
+		wake.notify_one();
+	}
+	green_thread* next() {
+		unique_lock<mutex> guard(lock);
+		while (true) {
+			if (!sleeping.empty()) {
+				chrono::steady_clock::time_point now = chrono::steady_clock::now();
+				while (!sleeping.empty() && sleeping.top()->wake <= now) {
+					ready.push_back(sleeping.top());
+					sleeping.pop();
+				}
+			}
+			if (!ready.empty()) {
+				green_thread* g = ready.front();
+				ready.pop_front();
+				return g;
+			}
+			if (sleeping.empty()) wake.wait(guard);
+			else wake.wait_until(guard, sleeping.top()->wake);
+		}
+	}
+	void loop() {
+		while (true) {
+			green_thread* g = next();
+			current_green = g;
+			green_fuel = GREEN_FUEL;
+			current_tx = g->tx;
+			const char* saved_limit = stack_limit;
+			stack_limit = g->stack + 4096 + STACK_RESERVE;
+			{
+				interpreter_scope scope(g->owner);
+				sched.switch_to(g->ctx);
+			}
+			stack_limit = saved_limit;
+			g->tx = current_tx;
+			current_green = 0;
+			green_fuel = 0;
+			current_tx = 0;
+			//g   ڿ  ڸ ű.
+			switch (g->state) {
+			case green_thread::Yielded: {// ϲ  ٽ Ƿ  ʿ䰡 .
+				lock_guard<mutex> guard(lock);
+				g->state = green_thread::Ready;
+				ready.push_back(g);
+				break;
+			}
+			case green_thread::Sleeping: {
+				lock_guard<mutex> guard(lock);
+				sleeping.push(g);
+				break;
+			}
+			case green_thread::Done:
+				finish(g);
+				break;
+			default://Parked: JOIN 밡  ʿ make_readyѴ.
+				break;
+			}
+		}
+	}
+	void finish(green_thread* g) {
+		gc_heap* heap = g->heap;//  g  g    ִ.
+		munmap(g->stack, GREEN_STACK);
+		g->stack = 0;
+		vector<green_thread*> waiting;
+		{
+			lock_guard<mutex> guard(g->lock);
+			g->finished = true;
+			waiting.swap(g->joiners);
+		}
+		g->done.notify_all();
+		for (size_t i = 0; i < waiting.size(); i++) waiting[i]->home->make_ready(waiting[i]);
+		load.fetch_sub(1);
+		if (heap) heap->leave();
+	}
+};
+//׸ 带 ϴ ϲ۵. ó SPAWN    ʴ´.
+//fork ڽ μ θ ϲ 尡  Ƿ ڽĿ ٽ .
+vector<green_worker*>& green_workers() {
+	static vector<green_worker*>* workers = 0;
+	static pid_t owner = 0;
+	static mutex made;
+	lock_guard<mutex> guard(made);
+	if (!workers || owner != getpid()) {
+		workers = new vector<green_worker*>;
+		owner = getpid();
+		size_t n = min((size_t)GREEN_WORKERS, max((size_t)1, (size_t)thread::hardware_concurrency()));
+		for (size_t i = 0; i < n; i++) workers->push_back(new green_worker);
+	}
+	return *workers;
+}
+// ׸ 忡 ϲ  ư. state ̸  д.
+void green_switch_out() {
+	green_thread* g = current_green;
+	g->ctx.switch_to(g->home->sched);
+}
+void green_entry(void* arg) {
+	green_thread* g = static_cast<green_thread*>(arg);
+	g->value = eval_body(g->body.list, 1, g->env);
+	g->state = green_thread::Done;
+	green_switch_out();
+}
+//   ϲۿ ñ.
+void green_spawn(green_thread* g) {
+	vector<green_worker*>& workers = green_workers();
+	green_worker* w = workers[0];
+	for (size_t i = 1; i < workers.size(); i++)
+		if (workers[i]->load.load() < w->load.load()) w = workers[i];
+	w->load.fetch_add(1);
+	if (g->heap) g->heap->enter();
+	g->home = w;
+	g->stack = (char*)mmap(0, GREEN_STACK, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	mprotect(g->stack, 4096, PROT_NONE);// ġ  ޸𸮸 ߸ ʰ ٷ ߵ
+	g->ctx.make(g->stack + 4096, GREEN_STACK - 4096, green_entry, g);
+	w->make_ready(g);
+}
+//eval Ḧ   θ.
+void green_preempt() {
+	current_green->state = green_thread::Yielded;
+	green_switch_out();
+}
+#else
+// ȯ  ʴ ÷ SPAWN   ڸ  Ѵ.
+void green_spawn(green_thread* g) {
+	g->value = eval_body(g->body.list, 1, g->env);
+	g->finished = true;
+}
+void green_preempt() {}
+#endif
+
+//(SPAWN ...)   ׸ 忡 ϱ ϰ, 带 ش.
+cell eval_spawn(const cell& x, environment* env) {
+	green_thread* g = new green_thread(x, env);
+	env->capture();
+	green_spawn(g);
+	cell result(Task);
+	result.obj = g;
+	return result;
+}
+//(YIELD) ٸ ׸ 忡 ʸ ѱ.
+cell proc_yield(const cells&) {
+	if (current_green) green_preempt();
+	else this_thread::yield();
+	return nil;
+}
+//(SLEEP и) ׸  ϲ  ʰ  常 .
+cell proc_sleep(const cells& c) {
+	if (c.empty() || c[0].type != Number) return error;
+	chrono::milliseconds ms((long long)atof(c[0].val.c_str()));
+#if defined(GREEN_ASM) || defined(GREEN_UCONTEXT)
+	if (current_green) {
+		current_green->wake = chrono::steady_clock::now() + ms;
+		current_green->state = green_thread::Sleeping;
+		green_switch_out();
 		return nil;
-	cell result(c[0]);
-	result.list.erase(result.list.begin());//ù°  ϰ ؾϹǷ 
+	}
+#endif
+	this_thread::sleep_for(ms);
+	return nil;
+}
+//(JOIN ) 尡   ٷ   ش.
+cell proc_join(const cells& c) {
+	if (c.empty() || c[0].type != Task) return error;
+	green_thread* g = static_cast<green_thread*>(c[0].obj);
+	unique_lock<mutex> guard(g->lock);
+#if defined(GREEN_ASM) || defined(GREEN_UCONTEXT)
+	if (current_green && !g->finished) {
+		g->joiners.push_back(current_green);
+		current_green->state = green_thread::Parked;
+		guard.unlock();
+		green_switch_out();
+		return g->value;
+	}
+#endif
+	g->done.wait(guard, [g] { return g->finished; });
+	return g->value;
+}
+
+//ä ٸ ׸ 峪 OS  ϳ.  äο Բ ɾ   ְ(SELECT),   .
+struct wait_token {
+	atomic<bool> fired;
+	green_thread* g;
+	mutex lock;
+	condition_variable cv;
+	wait_token() : fired(false), g(current_green) {}
+	bool fire() {
+		if (fired.exchange(true)) return false;
+#if defined(GREEN_ASM) || defined(GREEN_UCONTEXT)
+		if (g) {
+			g->home->make_ready(g);
+			return true;
+		}
+#endif
+		{
+			lock_guard<mutex> guard(lock);
+		}
+		cv.notify_one();
+		return true;
+	}
+	void wait() {
+#if defined(GREEN_ASM) || defined(GREEN_UCONTEXT)
+		if (g) {
+			green_switch_out();//state ɾ α  Parked ߴ.
+			return;
+		}
+#endif
+		unique_lock<mutex> guard(lock);
+		cv.wait(guard, [this] { return fired.load(); });
+	}
+};
+//ä (޴ ̳  ) ٸ ̵
+struct wait_queue {
+	atomic<size_t> count;// ο  ʰ ٸ ̰ ִ .
+	mutex lock;
+	deque<shared_ptr<wait_token>> tokens;
+	wait_queue() : count(0) {}
+	void add(const shared_ptr<wait_token>& t) {
+		lock_guard<mutex> guard(lock);
+		if (tokens.size() >= 64)//SELECT , ̹  ū ġ.
+			tokens.erase(remove_if(tokens.begin(), tokens.end(), [](const shared_ptr<wait_token>& x) { return x->fired.load(); }), tokens.end());
+		tokens.push_back(t);
+		count.store(tokens.size());
+	}
+	void wake_one() {
+		if (count.load() == 0) return;
+		lock_guard<mutex> guard(lock);
+		while (!tokens.empty()) {
+			shared_ptr<wait_token> t = tokens.front();
+			tokens.pop_front();
+			if (t->fire()) break;
+		}
+		count.store(tokens.size());
+	}
+};
+//뷮  ä . ڸ  ξ  ʰ  尡 ְ .
+struct mpmc_ring {
+	struct slot {
+		atomic<size_t> seq;//2*pos pos°   ְ, 2*pos + 1̸ pos°    ִ. 뷮 1̾  ġ ʴ´.
+		cell value;
+	};
+	size_t cap;
+	slot* slots;
+	alignas(64) atomic<size_t> head;//  
+	alignas(64) atomic<size_t> tail;//  
+
+	mpmc_ring(size_t cap) : cap(cap), slots(new slot[cap]), head(0), tail(0) {
+		for (size_t i = 0; i < cap; i++) slots[i].seq.store(2 * i, memory_order_relaxed);
+	}
+	~mpmc_ring() { delete[] slots; }
+	bool try_push(const cell& v) {
+		size_t pos = tail.load(memory_order_relaxed);
+		while (true) {
+			slot& s = slots[pos % cap];
+			size_t seq = s.seq.load(memory_order_acquire);
+			if (seq == 2 * pos) {
+				if (tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+					s.value = v;
+					s.seq.store(2 * pos + 1, memory_order_release);
+					return true;
+				}
+			}
+			else if ((ptrdiff_t)(seq - 2 * pos) < 0) return false;//     ƹ  ʾҴ:  
+			else pos = tail.load(memory_order_relaxed);
+		}
+	}
+	bool try_pop(cell& v) {
+		size_t pos = head.load(memory_order_relaxed);
+		while (true) {
+			slot& s = slots[pos % cap];
+			size_t seq = s.seq.load(memory_order_acquire);
+			if (seq == 2 * pos + 1) {
+				if (head.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+					v = s.value;
+					s.value = cell();
+					s.seq.store(2 * (pos + cap), memory_order_release);
+					return true;
+				}
+			}
+			else if ((ptrdiff_t)(seq - (2 * pos + 1)) < 0) return false;// 
+			else pos = head.load(memory_order_relaxed);
+		}
+	}
+};
+//뷮   ä .  ʴ Michael-Scott ť̴.
+//head   ڸ( )̰,    tail ű  尡  ٸ 尡  ű.
+//   ٸ 尡     Ƿ, 帶  ξٰ   Ϳ  ͸ .
+struct linked_queue {
+	struct node {
+		cell value;
+		atomic<node*> next;
+		node() : next(0) {}
+	};
+	enum { RECLAIM_BATCH = 64 };//  尡 ̸ŭ ̸   ִ  .
+	alignas(64) atomic<node*> head;
+	alignas(64) atomic<node*> tail;
+
+	linked_queue() {
+		node* n = new node;
+		head.store(n, memory_order_relaxed);
+		tail.store(n, memory_order_relaxed);
+	}
+	~linked_queue() {
+		for (node* n = head.load(); n; ) {
+			node* next = n->next.load();
+			delete n;
+			n = next;
+		}
+	}
+	void push(const cell& v) {
+		node* n = new node;
+		n->value = v;
+		global_reader& r = global_reader::mine();
+		while (true) {
+			node* t = protect(r.nodes[0], tail);
+			node* next = t->next.load(memory_order_acquire);
+			if (next) {//ٸ 尡 ̰ tail  ű ʾҴ.
+				tail.compare_exchange_weak(t, next);
+				continue;
+			}
+			node* expected = 0;
+			if (t->next.compare_exchange_weak(expected, n)) {
+				tail.compare_exchange_strong(t, n);
+				break;
+			}
+		}
+		r.nodes[0].store(0, memory_order_release);
+	}
+	bool try_pop(cell& v) {
+		global_reader& r = global_reader::mine();
+		node* h;
+		while (true) {
+			h = protect(r.nodes[0], head);
+			node* next = h->next.load(memory_order_acquire);
+			r.nodes[1].store(next);
+			if (head.load() != h) continue;//  h  next   ִ.
+			if (!next) {
+				h = 0;
+				break;
+			}
+			node* t = tail.load();
+			if (h == t) {//tail ó   Ű tail head ռ ʰ Ѵ.
+				tail.compare_exchange_weak(t, next);
+				continue;
+			}
+			if (head.compare_exchange_weak(h, next)) {// ̱ ʸ . next   ̴.
+				v = next->value;
+				next->value = cell();
+				break;
+			}
+		}
+		r.nodes[1].store(0, memory_order_release);
+		r.nodes[0].store(0, memory_order_release);
+		if (!h) return false;
+		retire(h);
+		return true;
+	}
+private:
+	//at Ű 带 hazard ,  ڿ ״ Ȯؼ ش.
+	static node* protect(atomic<const void*>& hazard, const atomic<node*>& at) {
+		node* n = at.load();
+		while (true) {
+			hazard.store(n);
+			node* now = at.load();
+			if (now == n) return n;
+			n = now;
+		}
+	}
+	struct retired_nodes {
+		vector<node*> nodes;
+		~retired_nodes() {//尡      .  ʹ   ιǷ  Ǯ.
+			while (reclaim(nodes)) this_thread::yield();
+		}
+	};
+	static void retire(node* n) {
+		thread_local retired_nodes retired;
+		retired.nodes.push_back(n);
+		if (retired.nodes.size() >= RECLAIM_BATCH) reclaim(retired.nodes);
+	}
+	// 嵵    带 ,   ش.
+	static size_t reclaim(vector<node*>& nodes) {
+		vector<const void*> in_use;
+		for (global_reader* r = global_reader::head.load(memory_order_acquire); r; r = r->next)
+			for (int i = 0; i < 2; i++) {
+				const void* h = r->nodes[i].load();
+				if (h) in_use.push_back(h);
+			}
+		size_t n = 0;
+		for (size_t i = 0; i < nodes.size(); i++) {
+			if (std::find(in_use.begin(), in_use.end(), nodes[i]) != in_use.end()) nodes[n++] = nodes[i];
+			else delete nodes[i];
+		}
+		nodes.resize(n);
+		return n;
+	}
+};
+struct channel : object {
+	mpmc_ring* ring;//뷮  
+	linked_queue* queue;//뷮   
+	wait_queue readers, writers;
+
+	channel(size_t cap) : ring(cap ? new mpmc_ring(cap) : 0), queue(cap ? 0 : new linked_queue) {}
+	~channel() {
+		delete ring;
+		delete queue;
+	}
+	void trace(gc_marker& m) const {// ڸ  cell  ιǷ  ˷ ȴ.
+		if (ring)
+			for (size_t i = 0; i < ring->cap; i++) m.mark(ring->slots[i].value);
+		else//head ű      Ƿ   ˸.
+			for (linked_queue::node* n = queue->head.load(); n; n = n->next.load()) m.mark(n->value);
+	}
+	bool try_send(const cell& v) {
+		if (ring) {
+			if (!ring->try_push(v)) return false;
+		}
+		else queue->push(v);
+		atomic_thread_fence(memory_order_seq_cst);//ٸ ̸ ɾ  ʰ  ʵ
+		readers.wake_one();
+		return true;
+	}
+	bool try_recv(cell& v) {
+		if (!(ring ? ring->try_pop(v) : queue->try_pop(v))) return false;
+		if (ring) {
+			atomic_thread_fence(memory_order_seq_cst);
+			writers.wake_one();
+		}
+		return true;
+	}
+};
+channel* as_channel(const cell& c) { return c.type == Channel ? static_cast<channel*>(c.obj) : 0; }
+//try   queues ɾ ΰ ٸ.  ڿ ٸ ̰    Ƿ ٽ  .
+template <class F> void channel_wait(const vector<wait_queue*>& queues, F try_op) {
+	while (!try_op()) {
+		shared_ptr<wait_token> t = make_shared<wait_token>();
+#if defined(GREEN_ASM) || defined(GREEN_UCONTEXT)
+		if (current_green) current_green->state = green_thread::Parked;
+#endif
+		for (size_t i = 0; i < queues.size(); i++) queues[i]->add(t);
+		atomic_thread_fence(memory_order_seq_cst);
+		if (try_op()) {//ɾ δ ̿  Դ.
+			if (!t->fired.exchange(true)) {
+#if defined(GREEN_ASM) || defined(GREEN_UCONTEXT)
+				if (current_green) current_green->state = green_thread::Ready;
+#endif
+				return;
+			}
+			//  췯  ȣ ٸ ̿ ѱ, ̹ غ ť  ڽ    ƿ´.
+			for (size_t i = 0; i < queues.size(); i++) queues[i]->wake_one();
+			t->wait();
+			return;
+		}
+		t->wait();
+	}
+}
+//(MAKE-CHANNEL [뷮]) 뷮     δ.
+cell proc_make_channel(const cells& c) {
+	size_t cap = 0;
+	if (!c.empty()) {
+		if (c[0].type != Number || atof(c[0].val.c_str()) < 1) return error;
+		cap = (size_t)atof(c[0].val.c_str());
+	}
+	cell result(Channel);
+	result.obj = new channel(cap);
 	return result;
 }
-cell proc_append(const cells& c) {// Ʈ ϳ ִ Լ
+//(SEND ä ) ä    ڸ   ٸ.   ʰ ״ ѱ.
+cell proc_send(const cells& c) {
+	channel* ch = c.size() == 2 ? as_channel(c[0]) : 0;
+	if (!ch) return error;
+	const cell& v = c[1];
+	channel_wait(vector<wait_queue*>(1, &ch->writers), [ch, &v] { return ch->try_send(v); });
+	return v;
+}
+//(RECV ä)    ٷ .
+cell proc_recv(const cells& c) {
+	channel* ch = c.size() == 1 ? as_channel(c[0]) : 0;
+	if (!ch) return error;
+	cell v;
+	channel_wait(vector<wait_queue*>(1, &ch->readers), [ch, &v] { return ch->try_recv(v); });
+	return v;
+}
+//(SELECT ä... [:DEFAULT ])    äο  (ä ) ش.
+//:DEFAULT ָ ٸ ʰ,       ش.
+cell proc_select(const cells& c) {
+	vector<channel*> chans;
+	vector<const cell*> owners;
+	vector<wait_queue*> queues;
+	const cell* fallback = 0;
+	for (size_t i = 0; i < c.size(); i++) {
+		if (c[i].type == Symbol && c[i].val == ":DEFAULT" && i + 1 < c.size()) {
+			fallback = &c[++i];
+			continue;
+		}
+		channel* ch = as_channel(c[i]);
+		if (!ch) return error;
+		chans.push_back(ch);
+		owners.push_back(&c[i]);
+		queues.push_back(&ch->readers);
+	}
+	size_t from = 0;
+	cell v;
+	// äθ    ʵ  ڸ .
+	static atomic<size_t> rotor(0);
+	size_t start = chans.empty() ? 0 : rotor.fetch_add(1, memory_order_relaxed) % chans.size();
+	auto try_any = [&] {
+		for (size_t k = 0; k < chans.size(); k++) {
+			size_t i = (start + k) % chans.size();
+			if (chans[i]->try_recv(v)) {
+				from = i;
+				return true;
+			}
+		}
+		return false;
+	};
+	if (fallback) {
+		if (!try_any()) return *fallback;
+	}
+	else if (chans.empty()) return error;
+	else channel_wait(queues, try_any);
 	cell result(List);
-	result.list = c[0].list;
-	for (int k = 1; k < c.size(); k++) {
-		for (cellit i = c[k].list.begin(); i != c[k].list.end(); ++i) result.list.push_back(*i);
+	result.list.push_back(*owners[from]);
+	result.list.push_back(v);
+	return result;
+}
+
+////////////////////// Ʈ ޸
+//REF ATOMICALLY ȿ Բ ٲٴ  ̴. Ʈ  ʰ  Ͱ    ξٰ,
+//   REF װ  REF   ٲ ʾҴ Ȯ  Ѳ . ٲ ó ٽ Ѵ.
+atomic<uint64_t> stm_clock(0);//Ŀ  1 þ  
+atomic<uint64_t> stm_commits(0), stm_aborts(0);
+
+struct stm_ref : object {
+	atomic<uint64_t> vlock;//   * 2. Ŀϴ  1Ʈ .
+	mutex lock;//value ϴ ȸ ´.
+	cell value;
+	stm_ref(const cell& value) : vlock(0), value(value) {}
+	void trace(gc_marker& m) const { m.mark(value); }
+	//  Բ д´. ٸ Ʈ  ̸   ٸ.
+	uint64_t read(cell& out) {
+		while (true) {
+			uint64_t v = vlock.load(memory_order_acquire);
+			if (!(v & 1)) {
+				{
+					lock_guard<mutex> guard(lock);
+					out = value;
+				}
+				if (vlock.load(memory_order_acquire) == v) return v;
+			}
+			this_thread::yield();
+		}
+	}
+};
+stm_ref* as_ref(const cell& c) { return c.type == Ref ? static_cast<stm_ref*>(c.obj) : 0; }
+
+struct stm_tx {
+	uint64_t rv;//  ĿԵ 鸸 Ҵ.
+	vector<pair<stm_ref*, uint64_t>> reads;
+	map<stm_ref*, cell> writes;//Ŀ  ּ  ᰡ  ʴ´.
+	bool doomed;//̹ ߳.    ʰ ٽ Ѵ.
+
+	void begin() {
+		rv = stm_clock.load(memory_order_acquire);
+		reads.clear();
+		writes.clear();
+		doomed = false;
+	}
+	// REF  ڷ ٲ ʾҴ. ڽ   Ѿ.
+	bool validate() const {
+		for (size_t i = 0; i < reads.size(); i++) {
+			uint64_t v = reads[i].first->vlock.load(memory_order_acquire);
+			if (v != reads[i].second && !(v == (reads[i].second | 1) && writes.count(reads[i].first))) return false;
+		}
+		return true;
+	}
+	cell deref(stm_ref* r) {
+		map<stm_ref*, cell>::iterator w = writes.find(r);
+		if (w != writes.end()) return w->second;
+		cell value;
+		uint64_t v = r->read(value);
+		if ((v >> 1) > rv) {// ڿ ĿԵ ̴.  ͵ ״θ    ģ.
+			uint64_t now = stm_clock.load(memory_order_acquire);
+			if (!validate()) {
+				doomed = true;
+				return error;
+			}
+			rv = now;
+			if ((v >> 1) > rv) v = r->read(value);
+			if ((v >> 1) > rv) {
+				doomed = true;
+				return error;
+			}
+		}
+		reads.push_back(make_pair(r, v));
+		return value;
+	}
+	bool commit() {
+		if (writes.empty()) return true;//б⸸    ȮǷ ״ .
+		vector<pair<stm_ref*, uint64_t>> locked;
+		bool ok = true;
+		for (map<stm_ref*, cell>::iterator w = writes.begin(); w != writes.end() && ok; ++w) {
+			uint64_t v = w->first->vlock.load(memory_order_relaxed);
+			ok = !(v & 1) && w->first->vlock.compare_exchange_strong(v, v | 1, memory_order_acquire);
+			if (ok) locked.push_back(make_pair(w->first, v));
+		}
+		uint64_t wv = ok ? stm_clock.fetch_add(1) + 1 : 0;
+		if (ok && wv != rv + 1) ok = validate();//  ƹ Ŀ ʾ Ȯ ʿ䰡 .
+		if (!ok) {
+			for (size_t i = 0; i < locked.size(); i++) locked[i].first->vlock.store(locked[i].second, memory_order_release);
+			return false;
+		}
+		for (map<stm_ref*, cell>::iterator w = writes.begin(); w != writes.end(); ++w) {
+			{
+				lock_guard<mutex> guard(w->first->lock);
+				w->first->value = w->second;
+			}
+			w->first->vlock.store(wv << 1, memory_order_release);
+		}
+		return true;
+	}
+};
+//body 浹  ĿԵ  ǮѴ. ̹ Ʈ ̸ ٱ Ʈǿ ģ.
+template <class F> cell stm_run(F body) {
+	if (current_tx) return body();
+	stm_tx tx;
+	current_tx = &tx;
+	for (int tries = 0;; tries++) {
+		tx.begin();
+		cell result = body();
+		if (!tx.doomed && tx.commit()) {
+			current_tx = 0;
+			stm_commits.fetch_add(1, memory_order_relaxed);
+			return result;
+		}
+		stm_aborts.fetch_add(1, memory_order_relaxed);
+		// REF ΰ  밡   .
+		if (current_green) green_preempt();
+		else if (tries < 8) this_thread::yield();
+		else this_thread::sleep_for(chrono::microseconds(min(tries, 100)));
+	}
+}
+//(ATOMICALLY ...)   DEREF ALTER   Ͼ ó .
+//浹ϸ  ó ٽ ϹǷ,  REF   ٲٸ   Ͼ  ִ.
+cell eval_atomically(const cell& x, environment* env) {
+	return stm_run([&] { return eval_body(x.list, 1, env); });
+}
+//(MAKE-REF )
+cell proc_make_ref(const cells& c) {
+	if (c.size() != 1) return error;
+	cell result(Ref);
+	result.obj = new stm_ref(c[0]);
+	return result;
+}
+//(DEREF ) Ʈ ۿ  ĿԵ  д´.
+cell proc_deref(const cells& c) {
+	stm_ref* r = c.size() == 1 ? as_ref(c[0]) : 0;
+	if (!r) return error;
+	if (current_tx) return current_tx->deref(r);
+	cell value;
+	r->read(value);
+	return value;
+}
+//(ALTER  Լ ...) (Լ 簪 ...)   ϰ ش. Ʈ ۿ ȥ  Ʈ ȴ.
+cell proc_alter(const cells& c) {
+	stm_ref* r = c.size() >= 2 ? as_ref(c[0]) : 0;
+	if (!r) return error;
+	return stm_run([&] {
+		cells args(c.begin() + 1, c.end());
+		args[0] = current_tx->deref(r);
+		if (current_tx->doomed) return error;
+		cell value = apply_proc(c[1], args);
+		current_tx->writes[r] = value;
+		return value;
+	});
+}
+//(GC)       Ѵ.  ߿ ÿ ִ    Ƿ ٷ  ʴ´.
+cell proc_gc(const cells&) {
+	lock_guard<mutex> guard(interp().heap.lock);
+	interp().heap.requested = true;
+	return true_sym;
+}
+//(GC-STATS)  Ƚ, ִ ü ȯ , ݱ  ,   ɸ и, ǥ  
+cell proc_gc_stats(const cells&) {
+	gc_heap& h = interp().heap;
+	lock_guard<mutex> guard(h.lock);
+	cell result(List);
+	result.list.push_back(cell(Symbol, ":COLLECTIONS"));
+	result.list.push_back(cell(Number, str((long long)h.collections)));
+	result.list.push_back(cell(Symbol, ":LIVE"));
+	result.list.push_back(cell(Number, str((long long)h.live)));
+	result.list.push_back(cell(Symbol, ":FREED"));
+	result.list.push_back(cell(Number, str((long long)h.freed)));
+	result.list.push_back(cell(Symbol, ":PAUSE-MS"));
+	result.list.push_back(cell(Number, to_string(h.pause_ms)));
+	result.list.push_back(cell(Symbol, ":MARKERS"));
+	result.list.push_back(cell(Number, str((long long)h.markers)));
+	return result;
+}
+//(STM-STATS) ݱ Ŀ Ʈ  浹 ٽ  
+cell proc_stm_stats(const cells&) {
+	cell result(List);
+	result.list.push_back(cell(Symbol, ":COMMITS"));
+	result.list.push_back(cell(Number, str((long long)stm_commits.load())));
+	result.list.push_back(cell(Symbol, ":ABORTS"));
+	result.list.push_back(cell(Number, str((long long)stm_aborts.load())));
+	return result;
+}
+
+stream* as_stream(const cell& c) { return c.type == Iterator ? static_cast<stream*>(c.obj) : 0; }
+cell stream_cell(stream* s) {
+	cell result(Iterator);
+	result.obj = s;
+	return result;
+}
+//Ʈ տ ϳ  
+struct list_stream : stream {
+	cell src;
+	size_t pos;
+	list_stream(const cell& src) : src(src), pos(0) {}
+	void trace(gc_marker& m) const { m.mark(src); }
+	bool next(cell& out) {
+		if (pos >= src.list.size()) return false;
+		out = src.list[pos++];
+		return true;
+	}
+};
+//Ʈ  Ͱ   ش.
+stream* to_stream(const cell& c) {
+	if (c.type == Iterator) return static_cast<stream*>(c.obj);
+	if (c.type == Vector) {
+		cells tmp;
+		cell l(List);
+		l.list = seq_elems(c, tmp);
+		return new list_stream(l);
+	}
+	if (c.type == List || (c.type == Symbol && c.val == "NIL")) return new list_stream(c);
+	return 0;
+}
+struct range_stream : stream {
+	long long cur, end, step;
+	bool infinite;
+	range_stream(long long start, long long end, long long step, bool infinite) : cur(start), end(end), step(step), infinite(infinite) {}
+	bool next(cell& out) {
+		if (!infinite && (step > 0 ? cur >= end : cur <= end)) return false;
+		out = cell(Number, str(cur));
+		cur += step;
+		return true;
+	}
+};
+struct map_stream : stream {
+	caller f;
+	stream* src;
+	map_stream(const cell& fn, stream* src) : f(fn, 1), src(src) {}
+	void trace(gc_marker& m) const {
+		f.trace(m);
+		m.mark(src);
+	}
+	bool next(cell& out) {
+		if (!src->next(f.args[0])) return false;
+		out = f.call();
+		return true;
+	}
+};
+struct filter_stream : stream {
+	caller f;
+	stream* src;
+	bool keep;//    true
+	filter_stream(const cell& fn, stream* src, bool keep) : f(fn, 1), src(src), keep(keep) {}
+	void trace(gc_marker& m) const {
+		f.trace(m);
+		m.mark(src);
+	}
+	bool next(cell& out) {
+		while (src->next(out)) {
+			f.args[0] = out;
+			if (is_false(f.call()) != keep) return true;
+		}
+		return false;
+	}
+};
+//  پ д .   \r .
+struct line_stream : stream {
+	ifstream in;
+	line_stream(const string& path) : in(path.c_str()) {}
+	bool next(cell& out) {
+		string line;
+		if (!getline(in, line)) return false;
+		if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+		out = cell(String, line);
+		return true;
+	}
+};
+
+//(LAZY-RANGE) 0 , (LAZY-RANGE ), (LAZY-RANGE   [])
+cell proc_lazy_range(const cells& c) {
+	for (cellit i = c.begin(); i != c.end(); ++i)
+		if (i->type != Number) return error;
+	long long start = 0, end = 0, step = 1;
+	if (c.size() == 1) end = atoll(c[0].val.c_str());
+	if (c.size() >= 2) {
+		start = atoll(c[0].val.c_str());
+		end = atoll(c[1].val.c_str());
+	}
+	if (c.size() >= 3) step = atoll(c[2].val.c_str());
+	if (step == 0) return error;
+	return stream_cell(new range_stream(start, end, step, c.empty()));
+}
+cell proc_lazy_map(const cells& c) {//(LAZY-MAP Լ )
+	stream* src = to_stream(c[1]);
+	if (!src) return error;
+	return stream_cell(new map_stream(c[0], src));
+}
+cell proc_lazy_filter(const cells& c) {//(LAZY-FILTER  )
+	stream* src = to_stream(c[1]);
+	if (!src) return error;
+	return stream_cell(new filter_stream(c[0], src, true));
+}
+cell proc_lazy_lines(const cells& c) {//(LAZY-LINES " ")
+	if (c[0].type != String) return error;
+	line_stream* s = new line_stream(c[0].val);
+	if (!s->in) {
+		delete s;
+		return error;
+	}
+	return stream_cell(s);
+}
+cell proc_lazy_seq(const cells& c) {//Ʈ  
+	stream* s = to_stream(c[0]);
+	return s ? stream_cell(s) : error;
+}
+//(TAKE n )  n Ʈ.   ׸ŭ Ѵ.
+cell proc_take(const cells& c) {
+	if (c[0].type != Number) return error;
+	long n = atol(c[0].val.c_str());
+	cells result;
+	stream* s = as_stream(c[1]);
+	if (s) {
+		cell e;
+		while ((long)result.size() < n && s->next(e)) result.push_back(e);
+	}
+	else {
+		cells tmp;
+		const cells& elems = seq_elems(c[1], tmp);
+		result.assign(elems.begin(), elems.begin() + min((size_t)max(n, 0L), elems.size()));
+	}
+	return list_cell(result);
+}
+//   REDUCE. Ҹ ϳ  ٷ Ƿ Ʈ  ʴ´.
+cell reduce_stream(const cells& c) {
+	stream* s = as_stream(c[1]);
+	caller f(c[0], 2);
+	bool has_acc = c.size() == 4 && c[2].val == ":INITIAL-VALUE";
+	cell acc = has_acc ? c[3] : cell();
+	cell e;
+	while (s->next(e)) {
+		if (!has_acc) {
+			acc = e;
+			has_acc = true;
+			continue;
+		}
+		f.args[0] = std::move(acc);
+		f.args[1] = e;
+		acc = f.call();
+	}
+	return has_acc ? acc : apply_proc(c[0], cells());
+}
+cell proc_next(const cells& c) {//(NEXT )  , ̸ NIL
+	stream* s = as_stream(c[0]);
+	if (!s) return error;
+	cell result;
+	if (!s->next(result)) return nil;
+	return result;
+}
+
+//////////////////////  ġ(fusion)
+//(REDUCE #'+ (MAPCAR F (FILTER P XS)))   ״ ϸ FILTER MAPCAR 
+//߰ Ʈ . eval ̷   try_fuse ܰ , XS  ϳ
+//P -> F -> + ʷ ϴ   ݺ Ѵ. ߰ Ʈ  ʴ´.
+//Ҹ ܰ谡  ȣǹǷ, Լ鿡 μȿ  ȣ  ޶  ִ.
+//  *FUSION* FALSE NIL θ ġ ʴ´. (  ӵ   )
+enum fuse_kind { FuseMap, FuseKeep, FuseDrop };
+
+struct fuse_stage {
+	fuse_kind kind;
+	caller f;
+	fuse_stage(fuse_kind kind, const cell& fn) : kind(kind), f(fn, 1) {}
+};
+
+//x (MAPCAR f seq), (FILTER p seq)   Ʈ¥ ܰ ȣ̸   ش.
+bool fuse_stage_kind(const cell& x, environment* env, fuse_kind& kind) {
+	if (x.type != List || !x.val.empty() || x.list.size() != 3 || x.list[0].type != Symbol) return false;
+	cell fn;
+	if (!env->get(x.list[0].val, fn) || fn.type != Proc) return false;
+	if (fn.proc == proc_mapcar) kind = FuseMap;
+	else if (fn.proc == proc_remove_if_not) kind = FuseKeep;
+	else if (fn.proc == proc_remove_if) kind = FuseDrop;
+	else return false;
+	return true;
+}
+bool try_fuse(const cell& x, environment* env, cell& result) {
+	if (x.list[0].type != Symbol || x.list.size() < 2) return false;
+	cell head;
+	if (!env->get(x.list[0].val, head) || head.type != Proc) return false;
+	cell::proc_type outer = head.proc;
+	size_t seq_at;//ٱ Լ Ʈ  ġ
+	if (outer == proc_length && x.list.size() == 2) seq_at = 1;
+	else if (outer == proc_reduce && (x.list.size() == 3 || (x.list.size() == 5 && x.list[3].val == ":INITIAL-VALUE"))) seq_at = 2;
+	else if ((outer == proc_mapcar || outer == proc_remove_if || outer == proc_remove_if_not ||
+		outer == proc_every || outer == proc_some) && x.list.size() == 3) seq_at = 2;
+	else return false;
+
+	fuse_kind kind;
+	if (!fuse_stage_kind(x.list[seq_at], env, kind)) return false;
+	cell flag;
+	if (env->get("*FUSION*", flag) && is_false(flag)) return false;
+
+	//Լ ڵ ó ٱʺ ϰ,    Ʈ Ѵ.
+	cell outer_fn = outer == proc_length ? nil : eval(x.list[1], env);
+	vector<fuse_stage> stages;//ٱ ܰ .
+	const cell* src = &x.list[seq_at];
+	while (fuse_stage_kind(*src, env, kind)) {
+		stages.push_back(fuse_stage(kind, eval(src->list[1], env)));
+		src = &src->list[2];
+	}
+	cell source = eval(*src, env);
+	cells tmp;
+	const cells& elems = seq_elems(source, tmp);
+	cell acc;
+	bool has_acc = false;
+	if (x.list.size() == 5) {
+		acc = eval(x.list[4], env);
+		has_acc = true;
+	}
+
+	caller g(outer_fn, outer == proc_reduce ? 2 : 1);
+	cells collected;
+	long long count = 0;
+	for (cellit e = elems.begin(); e != elems.end(); ++e) {
+		cell v = *e;
+		bool keep = true;
+		for (size_t s = stages.size(); keep && s-- > 0;) {
+			fuse_stage& st = stages[s];
+			st.f.args[0] = v;
+			if (st.kind == FuseMap) v = st.f.call();
+			else keep = is_false(st.f.call()) == (st.kind == FuseDrop);
+		}
+		if (!keep) continue;
+		if (outer == proc_length) count++;
+		else if (outer == proc_reduce) {
+			if (!has_acc) {
+				acc = v;
+				has_acc = true;
+				continue;
+			}
+			g.args[0] = std::move(acc);
+			g.args[1] = v;
+			acc = g.call();
+		}
+		else {
+			g.args[0] = v;
+			cell r = g.call();
+			if (outer == proc_mapcar) collected.push_back(r);
+			else if (outer == proc_every && is_false(r)) { result = false_sym; return true; }
+			else if (outer == proc_some && !is_false(r)) { result = r; return true; }
+			else if ((outer == proc_remove_if_not) != is_false(r)) collected.push_back(v);
+		}
+	}
+	if (outer == proc_length) result = cell(Number, str(count));
+	else if (outer == proc_reduce) result = has_acc ? acc : apply_proc(outer_fn, cells());
+	else if (outer == proc_every) result = true_sym;
+	else if (outer == proc_some) result = nil;
+	else result = list_cell(collected);
+	return true;
+}
+
+////////////////////// 
+const size_t SORT_PARALLEL_MIN = 1 << 16;//Ұ ̺     
+const size_t SORT_GRAIN = 1 << 14;// ϳ  ּ  
+
+//ĵ a[0, m) b[0, n) ģ   p  a   .
+// ̸ a   ( ) .
+template <class T, class Cmp>
+size_t merge_split(const T* a, size_t m, const T* b, size_t n, size_t p, Cmp cmp) {
+	size_t lo = p > n ? p - n : 0, hi = min(p, m);
+	while (lo < hi) {
+		size_t i = (lo + hi) / 2, j = p - i;
+		if (j > 0 && !cmp(b[j - 1], a[i])) lo = i + 1;
+		else hi = i;
+	}
+	return lo;
+}
+//Ұ     忡  ,   ϴ ܰ踦 ݺѴ.
+//յ   merge_split   尡 Բ Ѵ.
+template <class T, class Cmp>
+void parallel_sort(vector<T>& v, Cmp cmp, bool stable) {
+	size_t n = v.size(), workers = thread::hardware_concurrency(), parts = 1;
+	while (parts * 2 <= workers && n / (parts * 2) >= SORT_GRAIN) parts *= 2;
+	if (n < SORT_PARALLEL_MIN || parts < 2) {
+		if (stable) stable_sort(v.begin(), v.end(), cmp);
+		else sort(v.begin(), v.end(), cmp);
+		return;
+	}
+	vector<size_t> bound(parts + 1);
+	for (size_t i = 0; i <= parts; i++) bound[i] = n * i / parts;
+	parallel_for(parts, 1, [&](size_t p0, size_t p1) {
+		for (size_t p = p0; p < p1; p++) {
+			if (stable) stable_sort(v.begin() + bound[p], v.begin() + bound[p + 1], cmp);
+			else sort(v.begin() + bound[p], v.begin() + bound[p + 1], cmp);
+		}
+	});
+	vector<T> buf(n);
+	for (size_t width = 1; width < parts; width *= 2) {
+		size_t segs = width * 2;//   ̸ŭ 尡  ô´.
+		parallel_for(parts, 1, [&](size_t t0, size_t t1) {
+			for (size_t t = t0; t < t1; t++) {
+				size_t first = t / segs * segs, k = t % segs;
+				const T* a = &v[bound[first]];
+				const T* b = &v[bound[first + width]];
+				size_t m = bound[first + width] - bound[first], len = bound[first + segs] - bound[first];
+				size_t p0 = len * k / segs, p1 = len * (k + 1) / segs;
+				size_t i0 = merge_split(a, m, b, len - m, p0, cmp), i1 = merge_split(a, m, b, len - m, p1, cmp);
+				merge(a + i0, a + i1, b + (p0 - i0), b + (p1 - i1), buf.begin() + bound[first] + p0, cmp);
+			}
+		});
+		v.swap(buf);
+	}
+}
+
+//<, >  ڸ   Լ θ ʰ    Ѵ.
+template <class T>
+void sort_numbers(vector<pair<T, size_t> >& items, bool descending, bool stable) {
+	if (descending) parallel_sort(items, [](const pair<T, size_t>& a, const pair<T, size_t>& b) { return a.first > b.first; }, stable);
+	else parallel_sort(items, [](const pair<T, size_t>& a, const pair<T, size_t>& b) { return a.first < b.first; }, stable);
+}
+
+//items order[0], order[1], ... °   ٲ۴.
+template <class T>
+void permute(vector<T>& items, const vector<size_t>& order) {
+	vector<T> sorted(order.size());
+	for (size_t i = 0; i < order.size(); i++) sorted[i] = items[order[i]];
+	items.swap(sorted);
+}
+//(SORT   [:KEY Լ]) Ʈ   Ʈ ְ,  ʹ  ڸ Ѵ.
+cell sort_cells(const cells& c, bool stable) {
+	if (c.size() < 2 || (c[0].type != List && c[0].type != Vector && !(c[0].type == Symbol && c[0].val == "NIL"))) return error;
+	cell pred = c[1], key;
+	for (size_t i = 2; i + 1 < c.size(); i += 2) {
+		if (c[i].val != ":KEY") return error;
+		key = c[i + 1];
+	}
+	bool has_key = key.type == Proc || key.type == Lambda;
+	bool fast = pred.type == Proc && (pred.proc == proc_less || pred.proc == proc_greater);
+	bool descending = fast && pred.proc == proc_greater;
+
+	numvec* v = as_vec(c[0]);
+	if (v && fast && !has_key) {// ʹ Ҹ ٷ Ѵ.
+		if (v->is_float) {
+			if (descending) parallel_sort(v->flts, greater<double>(), stable);
+			else parallel_sort(v->flts, less<double>(), stable);
+		}
+		else {
+			if (descending) parallel_sort(v->ints, greater<long long>(), stable);
+			else parallel_sort(v->ints, less<long long>(), stable);
+		}
+		return c[0];
+	}
+
+	cells elems;
+	if (v) for (size_t i = 0; i < v->size(); i++) elems.push_back(vec_elem(v, i));
+	else elems = c[0].list;
+	cells keys;
+	if (has_key) {
+		keys.reserve(elems.size());
+		caller f(key, 1);
+		for (cellit i = elems.begin(); i != elems.end(); ++i) {
+			f.args[0] = *i;
+			keys.push_back(f.call());
+		}
+	}
+	const cells& k = has_key ? keys : elems;
+
+	vector<size_t> order;
+	for (cellit i = k.begin(); fast && i != k.end(); ++i)
+		if (i->type != Number) fast = false;
+	if (fast && check_float(k.begin(), k.end())) {
+		vector<pair<double, size_t> > items(k.size());
+		for (size_t i = 0; i < k.size(); i++) items[i] = make_pair(atof(k[i].val.c_str()), i);
+		sort_numbers(items, descending, stable);
+		for (size_t i = 0; i < items.size(); i++) order.push_back(items[i].second);
+	}
+	else if (fast) {
+		vector<pair<long long, size_t> > items(k.size());
+		for (size_t i = 0; i < k.size(); i++) items[i] = make_pair(atoll(k[i].val.c_str()), i);
+		sort_numbers(items, descending, stable);
+		for (size_t i = 0; i < items.size(); i++) order.push_back(items[i].second);
+	}
+	else {
+		//Ϲ   Լ  Ƿ  忡 ȣѴ.  ϰ ʾƵ
+		//(: <=)   ʴ   .
+		for (size_t i = 0; i < k.size(); i++) order.push_back(i);
+		caller f(pred, 2);
+		stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			f.args[0] = k[a];
+			f.args[1] = k[b];
+			return !is_false(f.call());
+		});
+	}
+
+	if (v) {//elems 6ڸ  ̹Ƿ, ǵ  ʰ   order ű.
+		if (v->is_float) permute(v->flts, order);
+		else permute(v->ints, order);
+		return c[0];
 	}
-	return result;
-}
-cell proc_cons(const cells& c)
-{
 	cell result(List);
-	result.list.push_back(c[0]);
-	for (cellit i = c[1].list.begin(); i != c[1].list.end(); ++i) result.list.push_back(*i);
-	return result;
+	result.list.reserve(order.size());
+	for (size_t i = 0; i < order.size(); i++) result.list.push_back(elems[order[i]]);
+	return result.list.empty() ? nil : result;
 }
-cell proc_list(const cells& c)
-{
-	cell result(List); result.list = c;
-	return result;
+cell proc_sort(const cells& c) { return sort_cells(c, false); }
+cell proc_stable_sort(const cells& c) { return sort_cells(c, true); }
+
+////////////////////// ݺ
+//ݺ   ȯ ݺ   ,  ݺ  ڸ  ٲ۴.
+//(ͷ ݺϸ     ȯ ϳ  C++ õ .)
+
+//forms[from]  ʷ ϰ   ش.
+cell eval_body(const cells& forms, size_t from, environment* env) {
+	if (from >= forms.size()) return nil;
+	for (size_t i = from; i + 1 < forms.size(); i++) eval_effect(forms[i], env);
+	return eval(forms.back(), env);
 }
-cell proc_reverse(const cells& c) {
-	cell result(List);
-	result.list = c[0].list;
-	reverse(result.list.begin(), result.list.end());
-	return result;
+//  ʴ ݺ 
+void run_body(const cells& forms, size_t from, environment* env) {
+	for (size_t i = from; i < forms.size(); i++) eval_effect(forms[i], env);
 }
-cell proc_member(const cells& c) {
-	cell result(List);
-	bool find = false;
-	for (cellit i = c[1].list.begin(); i != c[1].list.end(); ++i) {
-		if (i->val == c[0].val || find) {
-			find = true;
-			result.list.push_back(*i);
+//(DOTIMES ( Ƚ []) ...)  0 Ƚ-1 ٲ㰡  Ѵ.
+cell eval_dotimes(const cell& x, environment* env) {
+	if (x.list.size() < 2 || x.list[1].list.size() < 2) return error;
+	const cells& spec = x.list[1].list;
+	cell n = eval(spec[1], env);
+	if (n.type != Number) return error;
+	long long count = atoll(n.val.c_str());
+	scoped_frame frame(env, 1);
+	cell& var = frame->bind(spec[0].val, nil);
+	for (long long i = 0; i < count; i++) {
+		var = cell(Number, str(i));
+		run_body(x.list, 2, frame.env);
+	}
+	var = cell(Number, str(max(count, 0LL)));
+	return spec.size() > 2 ? eval(spec[2], frame.env) : nil;
+}
+//(PDOTIMES ( Ƚ [] [:GRAIN ]) ...) DOTIMES  ݺ  忡  Ѵ.
+//ݺ   Ƿ,   ٸ ( i° ĭ )  Ѵ.
+cell eval_pdotimes(const cell& x, environment* env) {
+	if (x.list.size() < 2 || x.list[1].list.size() < 2) return error;
+	const cells& spec = x.list[1].list;
+	cell n = eval(spec[1], env);
+	if (n.type != Number) return error;
+	long long count = max(atoll(n.val.c_str()), 0LL);
+	size_t grain = PAR_GRAIN;
+	const cell* result = 0;
+	for (size_t i = 2; i < spec.size(); i++) {
+		if (spec[i].val == ":GRAIN" && i + 1 < spec.size()) {
+			cell g = eval(spec[++i], env);
+			if (g.type != Number) return error;
+			grain = (size_t)max(1LL, atoll(g.val.c_str()));
 		}
+		else result = &spec[i];
 	}
-	if (!find) return nil;
-	return result;
+	const string& name = spec[0].val;
+	parallel_for((size_t)count, grain, [&](size_t i0, size_t i1) {
+		scoped_frame frame(env, 1);
+		cell& var = frame->bind(name, nil);
+		for (size_t i = i0; i < i1; i++) {
+			var = cell(Number, str((long long)i));
+			run_body(x.list, 2, frame.env);
+		}
+	});
+	if (!result) return nil;
+	scoped_frame frame(env, 1);
+	frame->bind(name, cell(Number, str(count)));
+	return eval(*result, frame.env);
 }
-cell proc_assoc(const cells& c) {
-	for (cellit i = c[1].list.begin(); i != c[1].list.end(); ++i) {
-		if (i->list[0].val == c[0].val) {
-			return *i;
+//(PCALL Լ ...) ڵ  忡 Բ   Լ θ.
+cell eval_pcall(const cell& x, environment* env) {
+	if (x.list.size() < 2) return error;
+	cell fn = eval(x.list[1], env);
+	cells args(x.list.size() - 2);
+	parallel_for(args.size(), 1, [&](size_t i0, size_t i1) {
+		for (size_t i = i0; i < i1; i++) args[i] = eval(x.list[i + 2], env);
+	});
+	if (fn.type == Proc)
+		for (size_t i = 0; i < args.size(); i++) args[i] = touch(args[i]);
+	return apply_proc(fn, args);
+}
+//(DOLIST ( Ʈ []) ...) Ʈ,  ,   Ҹ  Ѵ.
+cell eval_dolist(const cell& x, environment* env) {
+	if (x.list.size() < 2 || x.list[1].list.size() < 2) return error;
+	const cells& spec = x.list[1].list;
+	cell seq = eval(spec[1], env);
+	scoped_frame frame(env, 1);
+	cell& var = frame->bind(spec[0].val, nil);
+	stream* s = as_stream(seq);
+	if (s) {
+		while (s->next(var)) run_body(x.list, 2, frame.env);
+	}
+	else {
+		cells tmp;
+		const cells& elems = seq_elems(seq, tmp);
+		for (size_t i = 0; i < elems.size(); i++) {
+			var = elems[i];
+			run_body(x.list, 2, frame.env);
 		}
 	}
-	return nil;
+	var = nil;
+	return spec.size() > 2 ? eval(spec[2], frame.env) : nil;
 }
-cell proc_remove(const cells& c) {
-	cell result(List);
-	for (cellit i = c[1].list.begin(); i != c[1].list.end(); ++i) {
-		if (i->val != c[0].val) result.list.push_back(*i);
+//(DO (( ʱⰪ [])...) ( ...) ...)
+//   ڿ Ѳ  ִ´.
+cell eval_do(const cell& x, environment* env) {
+	if (x.list.size() < 3 || x.list[2].list.empty()) return error;
+	const cells& specs = x.list[1].list;
+	const cells& end = x.list[2].list;
+	for (size_t i = 0; i < specs.size(); i++)
+		if (specs[i].type != List || specs[i].list.empty()) return error;
+	scoped_frame frame(env, specs.size());
+	vector<cell*> vars(specs.size());
+	cells next(specs.size());
+	for (size_t i = 0; i < specs.size(); i++)
+		next[i] = specs[i].list.size() > 1 ? eval(specs[i].list[1], env) : nil;
+	for (size_t i = 0; i < specs.size(); i++)
+		vars[i] = &frame->bind(specs[i].list[0].val, next[i]);
+	while (is_false(eval(end[0], frame.env))) {
+		run_body(x.list, 3, frame.env);
+		for (size_t i = 0; i < specs.size(); i++)
+			if (specs[i].list.size() > 2) next[i] = eval(specs[i].list[2], frame.env);
+		for (size_t i = 0; i < specs.size(); i++)
+			if (specs[i].list.size() > 2) std::swap(*vars[i], next[i]);
 	}
-	return result;
+	return eval_body(end, 1, frame.env);
 }
-cell proc_subst(const cells& c) {
-	cell result(List);
-	for (cellit i = c[2].list.begin(); i != c[2].list.end(); ++i) {
-		if (i->val == c[1].val) result.list.push_back(c[0]);
-		else result.list.push_back(*i);
+
+//LOOP FOR  ϳ. (FOR x IN Ʈ) Ǵ (FOR i FROM a TO|BELOW|DOWNTO b BY s)
+struct loop_for {
+	cell* var;
+	bool numeric;
+	long long cur, end, step;
+	bool bounded, inclusive;
+	cell seq;//IN  Ʈ
+	size_t pos;
+	stream* s;
+};
+//(LOOP FOR ... [WHILE ] [UNTIL ] [COLLECT ] [SUM ] [COUNT ] [DO ...])
+//ϴ  LOOP Ϻ̴.     ݺ óȴ.
+cell eval_loop(const cell& x, environment* env) {
+	const cells& cl = x.list;
+	scoped_frame frame(env, cl.size() / 4);//FOR   ū ̴̻.
+	vector<loop_for> fors;
+	struct clause { string kind; size_t at, count; };
+	vector<clause> body;
+	for (size_t i = 1; i < cl.size();) {
+		const string& kw = cl[i].val;
+		if (kw == "FOR" && i + 3 < cl.size()) {
+			loop_for f;
+			f.var = &frame->bind(cl[i + 1].val, nil);
+			f.pos = 0;
+			f.s = 0;
+			if (cl[i + 2].val == "IN") {
+				f.numeric = false;
+				f.seq = eval(cl[i + 3], env);
+				f.s = as_stream(f.seq);
+				i += 4;
+			}
+			else if (cl[i + 2].val == "FROM") {
+				f.numeric = true;
+				f.cur = atoll(eval(cl[i + 3], env).val.c_str());
+				f.step = 1;
+				f.bounded = false;
+				f.inclusive = true;
+				i += 4;
+				long long by = 1;//BY DOWNTO    ͵ ǹǷ   δ.
+				bool down = false;
+				while (i + 1 < cl.size()) {
+					const string& k = cl[i].val;
+					if (k == "TO" || k == "BELOW" || k == "DOWNTO" || k == "ABOVE") {
+						f.end = atoll(eval(cl[i + 1], env).val.c_str());
+						f.bounded = true;
+						f.inclusive = k == "TO" || k == "DOWNTO";
+						down = k == "DOWNTO" || k == "ABOVE";
+					}
+					else if (k == "BY") by = atoll(eval(cl[i + 1], env).val.c_str());
+					else break;
+					i += 2;
+				}
+				f.step = down ? -by : by;
+			}
+			else return error;
+			fors.push_back(f);
+		}
+		else if (kw == "WHILE" || kw == "UNTIL" || kw == "COLLECT" || kw == "SUM" || kw == "COUNT") {
+			if (i + 1 >= cl.size()) return error;
+			clause c = { kw, i + 1, 1 };
+			body.push_back(c);
+			i += 2;
+		}
+		else if (kw == "DO") {// Ű(ɺ)  ĵ
+			clause c = { kw, i + 1, 0 };
+			for (i++; i < cl.size() && cl[i].type == List; i++) c.count++;
+			body.push_back(c);
+		}
+		else return error;
 	}
-	return result;
+
+	cells collected;
+	bool collecting = false, summing = false, sum_float = false;
+	long long isum = 0;
+	double fsum = 0;
+	for (bool first = true;; first = false) {
+		bool done = false;
+		for (size_t f = 0; f < fors.size() && !done; f++) {
+			loop_for& lf = fors[f];
+			if (lf.numeric) {
+				if (!first) lf.cur += lf.step;
+				if (lf.bounded && (lf.step > 0 ? (lf.inclusive ? lf.cur > lf.end : lf.cur >= lf.end)
+					: (lf.inclusive ? lf.cur < lf.end : lf.cur <= lf.end))) done = true;
+				else *lf.var = cell(Number, str(lf.cur));
+			}
+			else if (lf.s) done = !lf.s->next(*lf.var);
+			else {// ʹ Ҹ ϳ .
+				numvec* v = as_vec(lf.seq);
+				if (lf.pos >= (v ? v->size() : lf.seq.list.size())) done = true;
+				else *lf.var = v ? vec_elem(v, lf.pos++) : lf.seq.list[lf.pos++];
+			}
+		}
+		for (size_t b = 0; b < body.size() && !done; b++) {
+			const clause& c = body[b];
+			if (c.kind == "DO") {
+				for (size_t k = 0; k < c.count; k++) eval_effect(cl[c.at + k], frame.env);
+				continue;
+			}
+			cell v = eval(cl[c.at], frame.env);
+			if (c.kind == "WHILE") done = is_false(v);
+			else if (c.kind == "UNTIL") done = !is_false(v);
+			else if (c.kind == "COLLECT") {
+				collecting = true;
+				collected.push_back(v);
+			}
+			else if (c.kind == "COUNT") {
+				summing = true;
+				if (!is_false(v)) isum++;
+			}
+			else {//SUM
+				summing = true;
+				if (isfloat(v.val)) sum_float = true;
+				isum += atoll(v.val.c_str());
+				fsum += atof(v.val.c_str());
+			}
+		}
+		if (done || (fors.empty() && body.empty())) break;
+	}
+	if (collecting) return list_cell(collected);
+	if (summing) return sum_float ? cell(Number, to_string(fsum)) : cell(Number, str(isum));
+	return nil;
 }
-cell proc_minusp(const cells& c) {
-	if (c[0].type != Number) return error;
-	return c[0].val.find('-') == string::npos ? false_sym : true_sym;
+
+//////////////////////   Լ
+//(Ű ...) def.list[from]   ̰ Lambda .
+cell make_lambda(const cell& def, size_t from, environment* env) {
+	cell fn(Lambda);
+	fn.list.reserve(def.list.size() - from + 1);
+	fn.list.push_back(cell(Symbol, "LAMBDA"));
+	fn.list.insert(fn.list.end(), def.list.begin() + from, def.list.end());
+	fn.env = env;
+	env->capture();
+	return fn;
 }
-cell proc_zerop(const cells& c) {
-	if (c[0].type != Number) return error;
-	return c[0].val == "0" ? true_sym : false_sym;
+//(LET (( ) Ǵ  ...) ...)
+//LET   ٱ ȯ濡 ϰ, LET* տ       ִ.
+cell eval_let(const cell& x, environment* env, bool sequential) {
+	if (x.list.size() < 2) return error;
+	const cells& specs = x.list[1].list;
+	scoped_frame frame(env, specs.size());
+	for (size_t i = 0; i < specs.size(); i++) {
+		const cell& s = specs[i];
+		if (s.list.empty()) frame->bind(s.val, nil);
+		else frame->bind(s.list[0].val, s.list.size() > 1 ? eval(s.list[1], sequential ? frame.env : env) : nil);
+	}
+	return eval_body(x.list, 2, frame.env);
+}
+//(FLET ((̸ (Ű...) ...)...) ...)
+//LABELS Լ  ȯ ȿ Ƿ ڱ ڽŰ θ θ  ִ.
+cell eval_flet(const cell& x, environment* env, bool recursive) {
+	if (x.list.size() < 2) return error;
+	const cells& defs = x.list[1].list;
+	scoped_frame frame(env, defs.size());
+	for (size_t i = 0; i < defs.size(); i++) {
+		if (defs[i].list.size() < 2) return error;
+		frame->bind(defs[i].list[0].val, make_lambda(defs[i], 1, recursive ? frame.env : env));
+	}
+	return eval_body(x.list, 2, frame.env);
 }
-cell proc_equal(const cells& c) {
-	bool flag = check_float(c.begin(), c.end());
 
-	if (flag) {
-		float n(stof(c[0].val));
-		for (cellit i = c.begin() + 1; i != c.end(); ++i)
-			if (n == stof(i->val))
-				return true_sym;
-		return false_sym;
+////////////////////// ũ
+//ũ . ٽ ϸ serial ٲǷ,  Ƿ    ˾ƺ  ִ.
+struct macro_def : object {
+	unsigned long serial;
+	macro_def() {
+		static atomic<unsigned long> next_serial(0);
+		serial = ++next_serial;
 	}
-	else {
-		long n(atol(c[0].val.c_str()));
-		for (cellit i = c.begin() + 1; i != c.end(); ++i)
-			if (n == atol(i->val.c_str()))
-				return true_sym;
-		return false_sym;
+};
+//ũθ θ  ϳ ٴ ĳ.  cell Ǿ obj ʹ Ƿ,
+//Լ   ũ ȣ⵵ ó   .
+//ģ  ϴ 嵵 ϳ Ƿ, Ƿ ٲ  ħ     .
+struct macro_site : object {
+	unsigned long serial;
+	shared_ptr<const cell> expansion;
+	macro_site() : serial(0) {}
+	void trace(gc_marker& m) const {
+		if (expansion) m.mark(*expansion);
 	}
+};
+
+// Ŀ ũθ θ Ʈ ĳø δ. ο κ  Ƿ ǳʶڴ.
+void mark_macro_sites(cell& c) {
+	if (c.type != List || c.val == "\'" || c.val == "`" || c.val == "\"") return;
+	if (c.val.empty() && !c.obj && !c.list.empty() && c.list[0].type == Symbol && interp().macro_names.count(c.list[0].val))
+		c.obj = new macro_site;
+	for (size_t i = 0; i < c.list.size(); i++) mark_macro_sites(c.list[i]);
 }
-cell proc_stringp(const cells& c) {
-	return c[0].type == String ? true_sym : nil;
+//ũ m call  ģ. ڴ  ʰ  ״ ѱ.
+//&REST(Ǵ &BODY)  Ű  ڵ Ʈ ޴´.
+cell expand_macro(const cell& m, const cell& call) {
+	const cells& parms = m.list[1].list;
+	scoped_frame frame(m.env, parms.size());
+	size_t a = 1;
+	for (size_t i = 0; i < parms.size(); i++) {
+		if (parms[i].val == "&REST" || parms[i].val == "&BODY") {
+			cells rest(call.list.begin() + min(a, call.list.size()), call.list.end());
+			if (i + 1 < parms.size()) frame->bind(parms[i + 1].val, list_cell(rest));
+			break;
+		}
+		frame->bind(parms[i].val, a < call.list.size() ? call.list[a++] : nil);
+	}
+	cell expansion = eval_body(m.list, 2, frame.env);
+	mark_macro_sites(expansion);
+	return expansion;
 }
-cell proc_print(const cells& c) {
-	return c[0];
+//`  Ѵ.  ״ ε ,X ڸ X , ,@X ڸ X ҵ ִ´.
+//` ø  ʴ´.
+cell quasiquote(const cell& x, environment* env) {
+	if (x.type != List) return x;
+	if (x.val == ",") return eval(x.list[0], env);
+	if (x.val == "\"" || x.val == "#" || x.val == "`") return x;
+	cell result(List, x.val);
+	for (size_t i = 0; i < x.list.size(); i++) {
+		const cell& e = x.list[i];
+		if (e.type == List && e.val == ",@") {
+			cell v = eval(e.list[0], env);
+			if (v.type == List) result.list.insert(result.list.end(), v.list.begin(), v.list.end());
+			else if (v.val != "NIL") result.list.push_back(v);
+		}
+		else result.list.push_back(quasiquote(e, env));
+	}
+	if (result.list.empty() && result.val.empty()) return nil;
+	return result;
 }
 
+////////////////////// ı 
+//NCONC, NREVERSE  ù ڰ ڸ(place)̸  ڸ Ʈ  ʰ  ٲ۴.
+//ڸ ƴ ̸   ӽ÷ ޾Ƽ ٲ۴.
+
+//ڸ   ȿ  . take  ǥ    ڸ ٲٰ,  ٽ ܴ.
+//ƴϸ(:TEST Լ     ) 纻 ٲ  commit   ִ´.
+struct place_root {
+	bool take;
+	global_table* table;//   ǥ
+	cell* taken;
+	string global;//纻 ٲ  
+	cell value;
 
+	place_root(bool take = true) : take(take), table(0), taken(0) {}
+	~place_root() {
+		if (taken) table->restore(taken);
+	}
+	void commit(environment* env) {
+		if (!global.empty()) env->set(global, value);
+	}
+};
+//, (CAR ڸ), (NTH n ڸ), (GETHASH Ű ̺) Ű cell. ڸ ƴϸ 0
+//   ã  ڸ   ʿ   Ѵ.
+//create  GETHASH Ű NIL . SETF , о ٲٴ   Ű  ʴ´.
+cell* find_place(const cell& p, environment* env, place_root& root, bool create = false) {
+	if (p.type == Symbol) {
+		if (p.val[0] == ':') return 0;
+		cell* local = env->lookup_local(p.val);
+		if (local) return local;
+		if (root.take) {
+			root.table = &env->outermost()->globals();
+			return root.taken = root.table->take(p.val);
+		}
+		if (!env->get(p.val, root.value)) return 0;
+		root.global = p.val;
+		return &root.value;
+	}
+	if (p.type != List || !p.val.empty() || p.list.size() < 2) return 0;
+	const string& head = p.list[0].val;
+	if (head == "CAR") {
+		cell* l = find_place(p.list[1], env, root);
+		return l && l->type == List && !l->list.empty() ? &l->list[0] : 0;
+	}
+	if (head == "NTH" && p.list.size() == 3) {
+		long long i = atoll(eval(p.list[1], env).val.c_str());
+		cell* l = find_place(p.list[2], env, root);
+		return l && l->type == List && i >= 0 && i < (long long)l->list.size() ? &l->list[i] : 0;
+	}
+	if (head == "GETHASH" && p.list.size() == 3) {
+		cell key = eval(p.list[1], env);
+		hashtable* h = as_hash(eval(p.list[2], env));
+		if (!h) return 0;
+		hashtable::entry* e = h->find(key);
+		if (!e) {
+			if (!create) return 0;
+			h->put(key, nil);
+			e = h->find(key);
+		}
+		return &e->value;
+	}
+	return 0;
+}
+//(RPLACD Ʈ ) ù  ڸ  Ʈ ҵ ٲ۴.   Ƿ  Ʈ NIL̾ Ѵ.
+bool set_tail(cell& l, const cell& tail) {
+	if (l.type != List || l.list.empty()) return false;
+	if (tail.type != List && tail.val != "NIL") return false;
+	l.list.resize(1);
+	l.list.insert(l.list.end(), tail.list.begin(), tail.list.end());
+	return true;
+}
+//SUBST  tree  ٲ۴.
+void nsubst_tree(const cell& new_, const cell& old, cell& tree, cell_test& test) {
+	if (test(old, tree)) {
+		tree = new_;
+		return;
+	}
+	if (tree.type != List) return;
+	for (size_t i = 0; i < tree.list.size(); i++) nsubst_tree(new_, old, tree.list[i], test);
+}
+bool is_mutation(const string& head) {
+	return head == "SETF" || head == "NCONC" || head == "RPLACA" || head == "RPLACD"
+		|| head == "NREVERSE" || head == "DELETE" || head == "NSUBST";
+}
+//ı . want false(  ʴ ڸ ҷ) ٲ Ʈ   ʴ´.
+//ڵ  ϰ  ڸ ã´. ڸ ϴ ؽ ̺ Ŀ  ڸ Ű  ֱ ̴.
+cell eval_mutation(const cell& x, environment* env, bool want) {
+	const string& head = x.list[0].val;
+	if (head == "SETF") {//(SETF ڸ  ...)
+		cell value = nil;
+		for (size_t i = 1; i + 1 < x.list.size(); i += 2) {
+			const cell& p = x.list[i];
+			value = eval(x.list[i + 1], env);
+			const string& ph = p.type == List && !p.list.empty() ? p.list[0].val : "";
+			if (ph == "VREF" || ph == "MREF" || ph == "OMAP-GET") {// Ϳ OMAP cell  Ƿ ٲٴ Լ θ.
+				cells args;
+				for (size_t k = 1; k < p.list.size() && (ph != "OMAP-GET" || k < 3); k++) args.push_back(eval(p.list[k], env));
+				args.push_back(value);
+				cell r = ph == "VREF" ? proc_vset(args) : ph == "MREF" ? proc_mset(args) : proc_omap_put(args);
+				if (r.val == "ERROR") return error;
+				continue;
+			}
+			place_root root;
+			if (ph == "CDR") {
+				cell* l = find_place(p.list[1], env, root);
+				if (!l || !set_tail(*l, value)) return error;
+				continue;
+			}
+			if (p.type == Symbol) {//SETQ .
+				env->set(p.val, value);
+				continue;
+			}
+			cell* place = find_place(p, env, root, true);
+			if (!place) return error;
+			*place = value;
+		}
+		return value;
+	}
+	if (x.list.size() < 2) return error;
+	//ٲ Ʈ  ° . (DELETE  Ʈ), (NSUBST   Ʈ)
+	size_t target_at = head == "DELETE" ? 2 : head == "NSUBST" ? 3 : 1;
+	if (x.list.size() <= target_at) return error;
+	cells args;
+	for (size_t i = 1; i < x.list.size(); i++)
+		if (i != target_at) args.push_back(eval(x.list[i], env));
+	//:TEST Լ   ȿ ٲٴ    Ƿ   ؼ ٲ۴.
+	cell_test test(head == "DELETE" ? test_arg(args, 1) : head == "NSUBST" ? test_arg(args, 2) : nil);
+	cell tmp;
+	place_root root(!test.calls_function());
+	cell* target = find_place(x.list[target_at], env, root);
+	if (!target) {
+		tmp = eval(x.list[target_at], env);
+		target = &tmp;
+	}
+	if (target->type == Symbol && target->val == "NIL") {
+		if (head != "NCONC") return want ? nil : cell();
+		*target = cell(List);
+	}
+	if (target->type != List) return error;
+	cells& l = target->list.mut();
+	if (head == "NCONC") {
+		for (size_t i = 0; i < args.size(); i++)
+			if (args[i].type == List) l.insert(l.end(), make_move_iterator(args[i].list.begin()), make_move_iterator(args[i].list.end()));
+	}
+	else if (head == "RPLACA") {
+		if (l.empty()) return error;
+		l[0] = args[0];
+	}
+	else if (head == "RPLACD") {
+		if (!set_tail(*target, args[0])) return error;
+	}
+	else if (head == "NREVERSE")
+		reverse(l.begin(), l.end());
+	else if (head == "DELETE") {//(DELETE  Ʈ [:TEST Լ])
+		size_t n = 0;
+		for (size_t i = 0; i < l.size(); i++)
+			if (!test(args[0], l[i])) {
+				if (n != i) l[n] = std::move(l[i]);
+				n++;
+			}
+		l.resize(n);
+	}
+	else if (head == "NSUBST") {//(NSUBST   Ʈ [:TEST Լ])
+		nsubst_tree(args[0], args[1], *target, test);
+	}
+	if (target->type == List && target->list.empty() && target->val.empty()) *target = nil;
+	root.commit(env);
+	return want ? *target : cell();
+}
+//  ʴ  Ѵ.
+void eval_effect(const cell& x, environment* env) {
+	if (x.type == List && x.val.empty() && !x.list.empty() && x.list[0].type == Symbol && is_mutation(x.list[0].val))
+		eval_mutation(x, env, false);
+	else
+		eval(x, env);
+}
 
 ////////////////////// evalԼ
 //parser ش
-cell eval(cell x, environment* env) {
+cell eval(const cell& x, environment* env) {
+	if (green_fuel > 0 && --green_fuel == 0)//׸ 尡 Ḧ   ʸ ѱ.
+		green_preempt();
+	if (current_tx && current_tx->doomed)//߳ Ʈ  ѷ  ٽ Ѵ.
+		return error;
+	if (stack_overflow)
+		return error;
+	if (stack_exhausted()) {
+		*interp().out << "stack overflow\n";
+		stack_overflow = true;
+		return error;
+	}
 	if (x.type == Symbol) {
+		if (x.val[0] == ':')//:TEST  Ű ڱ ڽ 򰡵ȴ.
+			return x;
+		cell bound;
+		if (env->get(x.val, bound))//  ̹ 빮ڷ ٲ Ƿ κ ⼭ ã´.
+			return bound;
 		string upper_str = uppercase(x.val);
-		return env->find(upper_str)[upper_str];
-		//findԼ ؼ upper_str ȯ ش symbol ǵǾִ
-		//(Ǵ lambda  ִ) Լ ã´.
+		if (env->get(upper_str, bound))
+			return bound;
+		*interp().out << "unbound symbol '" << upper_str << endl;//ƹ͵ ã   .
+		return error;
 	}
 	if (x.type == Number)
 		return x;
@@ -387,33 +5087,49 @@ cell eval(cell x, environment* env) {
 		return x;
 	if (x.list.empty())
 		return nil;
-	if (x.list[0].type == Symbol || x.val == "\'" || x.val == "\"" || x.val == "#") {
+	if (x.list[0].type == Symbol || x.val == "\'" || x.val == "\"" || x.val == "#" || x.val == "`") {
+		if (x.val == "#" && x.list[0].type == List && x.list[0].val.empty())
+			return proc_vector(x.list[0].list);//#(0 1 2) 迭 ͷ
+		if (x.val == "#" && x.list[0].val == "\'")
+			return eval(x.list[0].list[0], env);//#'F  F Ű Լ
 		if (x.val == "\'" || x.val == "#")
 			return x.list[0];
+		if (x.val == "`")
+			return quasiquote(x.list[0], env);
 		if (x.val == "\"") {
-			x.list[0].val.pop_back();
-			return x.list[0];
+			cell s(x.list[0]);
+			s.val.pop_back();
+			return s;
+		}
+		//ū tokenize ̹ 빮ڷ ٲǷ, Ư  ̸ ״ Ѵ.
+		const string& head = x.list[0].val;
+		if (head == "IF") {       //cell   Լ if νϴ  Ѵ.
+			if (x.list.size() < 3) return error;
+			return eval(touch(eval(x.list[1], env)).val == "FALSE" ? (x.list.size() < 4 ? nil : x.list[3]) : x.list[2], env);
 		}
-		if (uppercase(x.list[0].val) == "IF")         //cell   Լ if νϴ  Ѵ.
-			return eval(eval(x.list[1], env).val == "FALSE" ? (x.list.size() < 4 ? nil : x.list[3]) : x.list[2], env);
-		if (uppercase(x.list[0].val) == "COND") {
+		if (head == "COND") {
 			int i;
 			for (i = 1; i < x.list.size(); i++) {
+				if (x.list[i].type != List || x.list[i].list.empty()) return error;
 				if (x.list[i].list.size() == 1) return eval(x.list[i].list[0], env);
-				if (eval(x.list[i].list[0], env).val == "TRUE") return eval(x.list[i].list[1], env);
+				if (touch(eval(x.list[i].list[0], env)).val == "TRUE") return eval(x.list[i].list[1], env);
 			}
 		}
 
-		if (uppercase(x.list[0].val) == "SETQ")      //cell   Լ setq νϴ  .
-			return (*env)[x.list[1].val] = eval(x.list[2], env);
-		if (uppercase(x.list[0].val) == "NTH") {
-			if (x.list[2].type != List || x.list[2].list[0].type == Symbol)
+		if (head == "SETQ") {     //cell   Լ setq νϴ  .
+			if (x.list.size() < 3 || x.list[1].type != Symbol) return error;
+			cell value = eval(x.list[2], env);
+			env->set(x.list[1].val, value);
+			return value;
+		}
+		if (head == "NTH") {
+			if (x.list.size() < 3 || x.list[1].type != Number || x.list[2].type != List || x.list[2].list.empty() || x.list[2].list[0].type == Symbol)
 				return error;
 
 			cells result(x.list[2].list[0].list);
-			int val = stoi(x.list[1].val);
+			long val = atol(x.list[1].val.c_str());
 
-			if (result.size() < val)
+			if (val < 0 || (long)result.size() <= val)
 				return nil;
 			return result[val];
 		}
@@ -421,15 +5137,99 @@ cell eval(cell x, environment* env) {
 		//cell  Լ Ϸ , if cond setq ϴµ    Լ eval
 		//Լ  ش  ϴ if ۼϿ.
 		//
-		if (x.list[0].val == "LAMBDA") {    // (lambda (var*) exp)
-			x.type = Lambda;
-			x.env = env;
-			return x;
+		if (head == "LAMBDA") {    // (lambda (var*) exp)
+			if (x.list.size() < 2) return error;
+			cell fn(x);
+			fn.type = Lambda;
+			fn.env = env;
+			env->capture();
+			return fn;
 			//Լ.  ڰ α׷ Լ Ͽ
 			//  ִ.
 		}
+		if (head == "DELAY") {//(DELAY )    ʰ  .
+			if (x.list.size() < 2) return error;
+			cell result(Promise);
+			result.obj = new promise(x.list[1], env);
+			env->capture();
+			return result;
+		}
+		if (head == "FUTURE")//(FUTURE )  ٸ 忡 ϱ ϰ ٷ ư.
+			return x.list.size() < 2 ? error : make_future(x.list[1], env);
+		if (head == "PCALL")
+			return eval_pcall(x, env);
+		if (head == "SPAWN")
+			return eval_spawn(x, env);
+		if (head == "ATOMICALLY")
+			return eval_atomically(x, env);
+		if (head == "LET" || head == "LET*")
+			return eval_let(x, env, head.size() == 4);
+		if (head == "FLET" || head == "LABELS")
+			return eval_flet(x, env, head == "LABELS");
+		if (head == "DEFMACRO") {//(DEFMACRO ̸ (Ű...) ...)
+			if (x.list.size() < 3) return error;
+			cell m = make_lambda(x, 2, env);
+			m.type = Macro;
+			m.obj = new macro_def;
+			env->outermost()->define(x.list[1].val, m);
+			interp().macro_names.insert(x.list[1].val);
+			return x.list[1];
+		}
+		if (is_mutation(head))
+			return eval_mutation(x, env, true);
+		if (head == "PROGN")
+			return eval_body(x.list, 1, env);
+		if (head == "DEFUN") {//(DEFUN ̸ (Ű...) ...)  Լ Ѵ.
+			if (x.list.size() < 3) return error;
+			env->outermost()->define(x.list[1].val, make_lambda(x, 2, env));
+			return x.list[1];
+		}
+		if (head == "PDOTIMES")
+			return eval_pdotimes(x, env);
+		if (head == "DOTIMES")
+			return eval_dotimes(x, env);
+		if (head == "DOLIST")
+			return eval_dolist(x, env);
+		if (head == "DO")
+			return eval_do(x, env);
+		if (head == "LOOP")
+			return eval_loop(x, env);
+		if (head == "TIME") {//(TIME )  ϴ  ɸ ð Ѵ.
+			if (x.list.size() < 2) return error;
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			cell result = eval(x.list[1], env);
+			*interp().out << "Elapsed: " << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() << " ms" << endl;
+			return result;
+		}
+		if (x.obj) {//ũ ȣ ڸ. ǰ ״θ  ģ  ٽ .
+			macro_site* site = static_cast<macro_site*>(x.obj);
+			cell m;
+			if (env->get(head, m) && m.type == Macro) {
+				unsigned long serial = static_cast<macro_def*>(m.obj)->serial;
+				shared_ptr<const cell> expansion;
+				{
+					lock_guard<mutex> lock(interp().macro_lock);
+					if (site->serial == serial) expansion = site->expansion;
+				}
+				if (!expansion) {
+					shared_ptr<const cell> fresh = make_shared<const cell>(expand_macro(m, x));
+					lock_guard<mutex> lock(interp().macro_lock);
+					if (site->serial != serial) {//ٸ 尡   װ  fresh .
+						site->expansion = fresh;
+						site->serial = serial;
+					}
+					expansion = site->expansion;
+				}
+				return eval(*expansion, env);
+			}
+		}
+		cell fused;
+		if (try_fuse(x, env, fused))
+			return fused;
 	}
 	cell proc(eval(x.list[0], env));
+	if (proc.type == Macro)//ũΰ ǵǱ    ĳð Ƿ Ź ģ.
+		return eval(expand_macro(proc, x), env);
 	cells exps;
 	for (cell::iter exp = x.list.begin() + 1; exp != x.list.end(); ++exp)
 		exps.push_back(eval(*exp, env));
@@ -438,22 +5238,27 @@ cell eval(cell x, environment* env) {
 	//environmentͿ outer, ڰ  Լ ִٰ  ٲְ,
 	//ο ڰ ǳ Լ ־ش.
 	if (proc.type == Lambda) {
-		return eval(proc.list[2], new environment(proc.list[1].list, exps, proc.env));
+		scoped_frame frame(proc.env);
+		frame->rebind(proc.list[1].list, exps);
+		return eval_body(proc.list, 2, frame.env);
 	}
 
-	if (proc.type == Proc)
-		return proc.proc(exps);
+	if (proc.type == Proc) {//Լ FUTURE  ٷȴٰ ޴´.
+		for (size_t i = 0; i < exps.size(); i++)
+			if (exps[i].type == Future) exps[i] = touch(exps[i]);
+		return call_proc(proc.proc, exps);
+	}
+	if (stack_overflow)//ģ ڿ  ̸ Լ ڸ error  翬ϴ.
+		return error;
 
-	std::cout << "not a function\n";
-	exit(1);
+	*interp().out << "not a function\n";
+	return error;
 
 }
 
 //ڸ string ٲ㼭 ȯִ Լ
-string str(long n) {
-	ostringstream os;
-	os << n;
-	return os.str();
+string str(long long n) {
+	return to_string(n);//ª ڴ string  ۿ Ƿ  Ҵ .
 }
 //ostringstream̶ ڿ format Ͽ  ٶ ϴ class̴.
 
@@ -464,7 +5269,7 @@ bool isdig(char c) {
 }
 
 //Էڰ 2.34, 1.03  Ҽ϶ true returnش.
-bool isfloat(string c) {
+bool isfloat(const string& c) {
 	return c.find('.') == string::npos ? false : true;
 }
 
@@ -487,13 +5292,119 @@ string uppercase(string up_string) {
 
 //while true  ؼ,
 // Է ޾ֵ Ǿִ repl Լ
-void repl(const string& prompt, environment* env)
+// (ȣ  ʾ  ) о Ѵ.
+//ǥ ̺귯  (޸  )  ĸ нŰ    ޴´.
+cell interpreter::eval_line(const string& line)
 {
-	while (true) {
-		cout << prompt;
-		string line; getline(cin, line);
-		cout << to_string(eval(read(line), env)) << endl;
+	interpreter_scope scope(this);
+	try {
+		return eval(read(line), &global_env);
+	}
+	catch (const exception& e) {
+		*out << e.what() << endl;
+		return error;
+	}
+}
+//Է   а ؼ  Ѵ.    ڰ  ̴.
+void interpreter::repl(const string& prompt)
+{
+	string line;
+	while (*out << prompt, getline(*in, line))
+		if (line.find_first_not_of(" \t\r") != string::npos) {//  ǳʶڴ.
+			*out << to_string(eval_line(line)) << endl;
+			collect(false);
+		}
+}
+// ĵ   ʷ Ѵ.
+bool interpreter::load(const string& path)
+{
+	ifstream file(path.c_str());
+	if (!file) return false;
+	istream* saved = in;
+	in = &file;// ٿ ģ  tokenize in  д´.
+	string line;
+	while (getline(file, line))
+		if (line.find_first_not_of(" \t\r") != string::npos) {
+			eval_line(line);
+			collect(false);
+		}
+	in = saved;
+	return true;
+}
+void gc_marking::run() {
+	gc_marker& first = *markers[0];
+	for (size_t i = 0; i < first.local.size(); i++) markers[i % markers.size()]->shared.push_back(first.local[i]);
+	first.local.clear();
+	for (size_t i = 0; i < markers.size(); i++) markers[i]->shared_size.store(markers[i]->shared.size());
+	parallel_for(markers.size(), 1, [this](size_t lo, size_t hi) {
+		for (size_t i = lo; i < hi; i++) markers[i]->run();
+	});
+}
+//heap ȣ GC_PAGE  尡  Ⱦ, ǥõ   items  dead .
+template <class T> void sweep_pages(vector<T*>& items, vector<size_t>& free_slots, const gc_bits& marks, vector<T*>& dead) {
+	vector<vector<T*> > pages((items.size() + GC_PAGE - 1) / GC_PAGE);
+	parallel_for(pages.size(), 1, [&](size_t lo, size_t hi) {
+		for (size_t p = lo; p < hi; p++)
+			for (size_t i = p * GC_PAGE; i < min((p + 1) * GC_PAGE, items.size()); i++)
+				if (items[i] && !marks.test(i)) {
+					pages[p].push_back(items[i]);
+					items[i] = 0;
+				}
+	});
+	for (size_t p = 0; p < pages.size(); p++)
+		for (size_t k = 0; k < pages[p].size(); k++) {
+			free_slots.push_back(pages[p][k]->gc_slot);
+			dead.push_back(pages[p][k]);
+		}
+}
+// θ.  ȯ ؽ ܽ ǥ  ʴ ü ȯ .
+//force ƴϸ       Ѵ.
+void interpreter::collect(bool force)
+{
+	unique_lock<mutex> guard(heap.lock);
+	if (heap.busy) return;
+	bool cons_grown = cons_table.size() - cons_kept >= max(GC_MIN, cons_kept);//ο Ʈ  о ǥ δ.
+	if (!force && !heap.requested && heap.allocated < max(GC_MIN, heap.kept) && !cons_grown) return;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	heap.finish_sweep();//  ⸦      .
+	{//ǥ  ִ Ҹ . ٱ Ʈ   Ʈ ǥ    Ƿ     .
+		lock_guard<mutex> lock(cons_lock);
+		for (bool pruned = true; pruned;) {
+			pruned = false;
+			for (auto i = cons_table.begin(); i != cons_table.end();) {
+				if (i->second.use_count() == 1) {
+					i = cons_table.erase(i);
+					pruned = true;
+				}
+				else ++i;
+			}
+		}
+		cons_kept = cons_table.size();
 	}
+	gc_marking m(heap, &global_env, work_pool::get().size());
+	gc_marker& roots = *m.markers[0];
+	global_env.trace(roots);
+	for (auto i = cons_table.begin(); i != cons_table.end(); ++i)
+		for (size_t k = 0; k < i->second->items.size(); k++) roots.mark(i->second->items[k]);
+	for (size_t i = 0; i < heap.objects.size(); i++)
+		if (heap.objects[i] && heap.objects[i]->pinned()) roots.mark(heap.objects[i]);
+	m.run();
+	shared_ptr<gc_sweep> dead(new gc_sweep);
+	sweep_pages(heap.objects, heap.free_objects, m.object_marks, dead->objects);
+	sweep_pages(heap.envs, heap.free_envs, m.env_marks, dead->envs);
+	for (size_t i = 0; i < dead->objects.size(); i++) dead->objects[i]->heap = 0;//Ҹڰ heap ǵ帮 ʰ Ѵ.
+	heap.live -= dead->objects.size() + dead->envs.size();
+	heap.freed += dead->objects.size() + dead->envs.size();
+	heap.allocated = 0;
+	heap.kept = heap.live;
+	heap.requested = false;
+	heap.collections++;
+	heap.markers = m.markers.size();
+	heap.sweep = dead;
+	guard.unlock();
+	//Ҹڴ    ϲ ϳ θ. ϲ  ⼭ θ.
+	if (!work_pool::get().submit([dead] { if (dead->claim()) dead->run(); }) && dead->claim()) dead->run();
+	heap.pause_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
 }
 
 
@@ -501,16 +5412,17 @@ void repl(const string& prompt, environment* env)
 cell read(const string& s)
 {
 	list<string> tokens(tokenize(s));
-	return read_from(tokens);
+	cell c = read_from(tokens);
+	mark_macro_sites(c);
+	return c;
 }
 
 
 //Է  str ūȭ Ͽ ū list ȯִ Լ.
 //lexer شѴ.
-list<string> tokenize(const string& str) {
-	list<string> tokens;
+//  ū  tokens ڿ δ. front    ȣ ̴.
+void tokenize_line(const string& str, list<string>& tokens, int& front) {
 	const char* s = str.c_str();
-	static int front = 0;
 	while (*s) {
 		while (*s == ' ') {//lisp ū ' '   . ex: setq () x () 3
 			++s;
@@ -523,14 +5435,28 @@ list<string> tokenize(const string& str) {
 			tokens.push_back("\'");
 			s++;
 		}
+		else if (*s == '`') {
+			tokens.push_back("`");
+			s++;
+		}
+		else if (*s == ',') {//,@ Ʈ ҵ  ִ´.
+			tokens.push_back(s[1] == '@' ? ",@" : ",");
+			s += s[1] == '@' ? 2 : 1;
+		}
 		else if (*s == '\"') {
 			tokens.push_back("\"");
 			s++;
-			const char* t = s;
-			while (*t && *t != '(' && *t != ')') {
-				++t;
+			const char* t = strchr(s, '\"');
+			if (t) {//ݴ ǥ ڿ.    ̹Ƿ ҹڸ ״ д.
+				tokens.push_back(string(s, ++t));
+			}
+			else {
+				t = s;
+				while (*t && *t != '(' && *t != ')') {
+					++t;
+				}
+				tokens.push_back(uppercase(string(s, t)));
 			}
-			tokens.push_back(uppercase(string(s, t)));
 			s = t;
 		}
 		else if (*s == '#') {
@@ -546,9 +5472,16 @@ list<string> tokenize(const string& str) {
 			s = t;
 		}
 	}
-	if (front != 0) {
-		string line; getline(cin, line);
-		tokens.splice(tokens.end(), tokenize(line));
+}
+//ȣ  ʾ   ٷ ̾Ƿ   д´.
+//ȣ  ȣ⸶  Ƿ  忡 ҷ   ʴ´.
+list<string> tokenize(const string& str) {
+	list<string> tokens;
+	int front = 0;
+	string line(str);
+	while (true) {
+		tokenize_line(line, tokens, front);
+		if (front <= 0 || !getline(*interp().in, line)) break;
 	}
 	return tokens;
 }
@@ -556,19 +5489,23 @@ list<string> tokenize(const string& str) {
 
 //ū list lisp  ȯִ Լ.
 cell read_from(list<string>& tokens) {
+	if (tokens.empty()) return error;//Է µ ȣ  ʾҴ.
 	const string token(tokens.front());
 	tokens.pop_front();
 
 	if (token == "(") {
 		cell c(List);
-		while (tokens.front() != ")")
+		while (!tokens.empty() && tokens.front() != ")")
 			c.list.push_back(read_from(tokens));
-		tokens.pop_front();
+		if (!tokens.empty()) tokens.pop_front();
 		return c;
 	}
-	else if (token == "\'") {
+	else if (token == "\'") {//ο Ʈ ٲ Ƿ ؽ ܽ д.
 		cell c(List, "\'");
-		c.list.push_back(read_from(tokens));
+		cell datum = read_from(tokens);
+		lock_guard<mutex> lock(interp().cons_lock);
+		hash_cons(datum);
+		c.list.push_back(datum);
 		return c;
 	}
 	else if (token == "\"") {
@@ -581,6 +5518,11 @@ cell read_from(list<string>& tokens) {
 		c.list.push_back(read_from(tokens));
 		return c;
 	}
+	else if (token == "`" || token == "," || token == ",@") {
+		cell c(List, token);
+		c.list.push_back(read_from(tokens));
+		return c;
+	}
 	//caddr car(cdr(cdr ø ٲپ־, ش Լ  ϰѴ.
 	else if ((token.substr(0, 2) == "CA" || token.substr(0, 2) == "CD") && (token.size() > 2 && token[2] != 'R')) {
 		cell c(List);
@@ -628,9 +5570,74 @@ string to_string(const cell& exp)
 		return "<Proc>";
 	else if (exp.type == Lambda)
 		return "<Lambda>";
+	else if (exp.type == Macro)
+		return "<Macro>";
+	else if (exp.type == OMap)
+		return "#<OMAP :COUNT " + str((long long)static_cast<const omap*>(exp.obj)->root->size) + ">";
+	else if (exp.type == Iterator)
+		return "#<LAZY-SEQ>";
+	else if (exp.type == Promise)
+		return "#<PROMISE>";
+	else if (exp.type == Task)
+		return "#<TASK>";
+	else if (exp.type == Channel)
+		return "#<CHANNEL>";
+	else if (exp.type == Ref)
+		return "#<REF>";
+	else if (exp.type == Future) {//̹   ش.
+		const future_value* f = static_cast<const future_value*>(exp.obj);
+		return f->state.load() == 2 ? to_string(f->value) : "#<FUTURE>";
+	}
+	else if (exp.type == Hash) {
+		const hashtable* h = static_cast<const hashtable*>(exp.obj);
+		return string("#<HASH-TABLE :TEST ") + (h->deep ? "EQUAL" : "EQL") + " :COUNT " + str((long long)h->count) + ">";
+	}
+	else if (exp.type == Vector) {
+		const numvec* v = static_cast<const numvec*>(exp.obj);
+		if (v->is_matrix()) {//#2A((1 2) (3 4))
+			string s("#2A(");
+			for (size_t i = 0; i < v->rows; i++) {
+				s += i ? " (" : "(";
+				for (size_t j = 0; j < v->cols; j++)
+					s += (j ? " " : "") + vec_elem(v, i * v->cols + j).val;
+				s += ')';
+			}
+			return s + ')';
+		}
+		string s("#(");
+		for (size_t i = 0; i < v->size(); i++)
+			s += (i ? " " : "") + vec_elem(v, i).val;
+		return s + ')';
+	}
 	return exp.val;
 }
 
+//Լ ޾ƾ ϴ ּ  .    Ȯϴ Լ  ʴ´.
+size_t min_args(cell::proc_type p) {
+	static const unordered_map<cell::proc_type, size_t> table = {
+		{ &proc_car, 1 }, { &proc_cdr, 1 }, { &proc_cons, 2 }, { &proc_length, 1 },
+		{ &proc_member, 2 }, { &proc_assoc, 2 }, { &proc_remove, 2 }, { &proc_subst, 3 },
+		{ &proc_null, 1 }, { &proc_sub, 1 }, { &proc_div, 1 }, { &proc_greater, 1 },
+		{ &proc_less, 1 }, { &proc_less_equal, 1 }, { &proc_greater_equal, 1 }, { &proc_equal, 1 },
+		{ &proc_reverse, 1 }, { &proc_atom, 1 }, { &proc_numberp, 1 }, { &proc_zerop, 1 },
+		{ &proc_minusp, 1 }, { &proc_stringp, 1 }, { &proc_eq, 2 }, { &proc_eql, 2 },
+		{ &proc_equal_deep, 2 }, { &proc_union, 2 }, { &proc_intersection, 2 }, { &proc_set_difference, 2 },
+		{ &proc_remove_duplicates, 1 }, { &proc_hash_cons, 1 }, { &proc_print, 1 }, { &proc_make_vector, 1 },
+		{ &proc_vref, 2 }, { &proc_vset, 3 }, { &proc_vsum, 1 }, { &proc_vdot, 2 },
+		{ &proc_vmin, 1 }, { &proc_vmax, 1 }, { &proc_matrix, 1 }, { &proc_mref, 3 },
+		{ &proc_mset, 4 }, { &proc_matmul, 2 }, { &proc_transpose, 1 }, { &proc_solve, 2 },
+		{ &proc_gethash, 2 }, { &proc_sethash, 3 }, { &proc_remhash, 2 }, { &proc_hash_count, 1 },
+		{ &proc_clrhash, 1 }, { &proc_maphash, 2 }, { &proc_hash_pairs, 1 }, { &proc_hash_keys, 1 },
+		{ &proc_hash_values, 1 }, { &proc_omap_put, 3 }, { &proc_omap_get, 2 }, { &proc_omap_remove, 2 },
+		{ &proc_omap_count, 1 }, { &proc_omap_nth, 2 }, { &proc_omap_min, 1 }, { &proc_omap_max, 1 },
+		{ &proc_omap_rank, 2 }, { &proc_omap_range, 1 }, { &proc_omap_next, 1 }, { &proc_funcall, 1 },
+		{ &proc_force, 1 }, { &proc_touch, 1 }, { &proc_join, 1 }, { &proc_lazy_map, 2 },
+		{ &proc_lazy_filter, 2 }, { &proc_lazy_lines, 1 }, { &proc_lazy_seq, 1 }, { &proc_take, 2 },
+		{ &proc_next, 1 }
+	};
+	unordered_map<cell::proc_type, size_t>::const_iterator i = table.find(p);
+	return i == table.end() ? 0 : i->second;
+}
 
 //Է¹ environment env, [] ȣ شϴ ϰ, شϴ Լ ͸ cell()
 //־ cellȭ Ų,env[] returnѴ.
@@ -641,6 +5648,7 @@ string to_string(const cell& exp)
 void add_globals(environment& env)
 {
 	env["NIL"] = nil;   env["#F"] = false_sym;  env["#T"] = true_sym;
+	env["*FUSION*"] = true_sym;
 	env["APPEND"] = cell(&proc_append);   env["CAR"] = cell(&proc_car);
 	env["CDR"] = cell(&proc_cdr);      env["CONS"] = cell(&proc_cons);
 	env["LENGTH"] = cell(&proc_length);   env["LIST"] = cell(&proc_list);
@@ -653,16 +5661,505 @@ void add_globals(environment& env)
 	env[">="] = cell(&proc_greater_equal);
 	env["="] = cell(&proc_equal);
 	env["REVERSE"] = cell(&proc_reverse); env["ERROR"] = error;
+	//ı  Ư ̰, #'NCONCó Լ ѱ ϴ ʰ  Ѵ.
+	env["NCONC"] = cell(&proc_append); env["NREVERSE"] = cell(&proc_reverse);
+	env["DELETE"] = cell(&proc_remove); env["NSUBST"] = cell(&proc_subst);
 	env["ATOM"] = cell(&proc_atom); env["NUMBERP"] = cell(&proc_numberp);
 	env["ZEROP"] = cell(&proc_zerop); env["MINUSP"] = cell(&proc_minusp);
-	env["EQUAL"] = cell(&proc_equal); env["STRINGP"] = cell(&proc_stringp);
+	env["EQUAL"] = cell(&proc_equal_deep); env["STRINGP"] = cell(&proc_stringp);
+	env["EQ"] = cell(&proc_eq); env["EQL"] = cell(&proc_eql);
+	env["UNION"] = cell(&proc_union); env["INTERSECTION"] = cell(&proc_intersection);
+	env["SET-DIFFERENCE"] = cell(&proc_set_difference); env["REMOVE-DUPLICATES"] = cell(&proc_remove_duplicates);
+	env["HASH-CONS"] = cell(&proc_hash_cons);
 	env["PRINT"] = cell(&proc_print);
+	env["VECTOR"] = cell(&proc_vector); env["MAKE-VECTOR"] = cell(&proc_make_vector);
+	env["VREF"] = cell(&proc_vref); env["VSET!"] = cell(&proc_vset);
+	env["V+"] = cell(&proc_vadd);   env["V*"] = cell(&proc_vmul);
+	env["VSUM"] = cell(&proc_vsum); env["VDOT"] = cell(&proc_vdot);
+	env["VMIN"] = cell(&proc_vmin); env["VMAX"] = cell(&proc_vmax);
+	env["MAKE-MATRIX"] = cell(&proc_make_matrix); env["MATRIX"] = cell(&proc_matrix);
+	env["MREF"] = cell(&proc_mref); env["MSET!"] = cell(&proc_mset);
+	env["MATMUL"] = cell(&proc_matmul); env["TRANSPOSE"] = cell(&proc_transpose);
+	env["SOLVE"] = cell(&proc_solve);
+	env["MAKE-HASH-TABLE"] = cell(&proc_make_hash_table); env["GETHASH"] = cell(&proc_gethash);
+	env["SETHASH"] = cell(&proc_sethash); env["REMHASH"] = cell(&proc_remhash);
+	env["HASH-COUNT"] = cell(&proc_hash_count); env["CLRHASH"] = cell(&proc_clrhash);
+	env["MAPHASH"] = cell(&proc_maphash); env["HASH-PAIRS"] = cell(&proc_hash_pairs);
+	env["HASH-KEYS"] = cell(&proc_hash_keys); env["HASH-VALUES"] = cell(&proc_hash_values);
+	env["MAKE-OMAP"] = cell(&proc_make_omap); env["OMAP-PUT"] = cell(&proc_omap_put);
+	env["OMAP-GET"] = cell(&proc_omap_get); env["OMAP-REMOVE"] = cell(&proc_omap_remove);
+	env["OMAP-COUNT"] = cell(&proc_omap_count); env["OMAP-NTH"] = cell(&proc_omap_nth);
+	env["OMAP-MIN"] = cell(&proc_omap_min); env["OMAP-MAX"] = cell(&proc_omap_max);
+	env["OMAP-RANK"] = cell(&proc_omap_rank); env["OMAP-RANGE"] = cell(&proc_omap_range);
+	env["OMAP-NEXT"] = cell(&proc_omap_next);
+	env["SORT"] = cell(&proc_sort); env["STABLE-SORT"] = cell(&proc_stable_sort);
+	env["FUNCALL"] = cell(&proc_funcall); env["APPLY"] = cell(&proc_apply);
+	env["MAPCAR"] = cell(&proc_mapcar); env["REDUCE"] = cell(&proc_reduce);
+	env["PMAP"] = cell(&proc_pmap); env["PREDUCE"] = cell(&proc_preduce);
+	env["REMOVE-IF"] = cell(&proc_remove_if); env["REMOVE-IF-NOT"] = cell(&proc_remove_if_not);
+	env["FILTER"] = cell(&proc_remove_if_not);
+	env["EVERY"] = cell(&proc_every); env["SOME"] = cell(&proc_some);
+	env["FORCE"] = cell(&proc_force); env["TOUCH"] = cell(&proc_touch);
+	env["YIELD"] = cell(&proc_yield); env["SLEEP"] = cell(&proc_sleep); env["JOIN"] = cell(&proc_join); env["LAZY-RANGE"] = cell(&proc_lazy_range);
+	env["MAKE-CHANNEL"] = cell(&proc_make_channel); env["SEND"] = cell(&proc_send); env["RECV"] = cell(&proc_recv); env["SELECT"] = cell(&proc_select);
+	env["MAKE-REF"] = cell(&proc_make_ref); env["DEREF"] = cell(&proc_deref); env["ALTER"] = cell(&proc_alter); env["STM-STATS"] = cell(&proc_stm_stats);
+	env["GC"] = cell(&proc_gc); env["GC-STATS"] = cell(&proc_gc_stats);
+	env["LAZY-MAP"] = cell(&proc_lazy_map); env["LAZY-FILTER"] = cell(&proc_lazy_filter);
+	env["LAZY-LINES"] = cell(&proc_lazy_lines); env["LAZY-SEQ"] = cell(&proc_lazy_seq);
+	env["TAKE"] = cell(&proc_take); env["NEXT"] = cell(&proc_next);
+}
+
+#ifndef _WIN32
+////////////////////// ϲ μ
+// ٸ  ̸. α׿ .
+string listen_name(const string& path, int port) { return port > 0 ? "127.0.0.1:" + to_string(port) : path; }
+//port  127.0.0.1  TCP Ʈ,  path н Ͽ  ٸ.  ϸ -1.
+int listen_on(const string& path, int port) {
+	int listener = socket(port > 0 ? AF_INET : AF_UNIX, SOCK_STREAM, 0);
+	bool ok = listener >= 0;
+	if (ok && port > 0) {
+		sockaddr_in addr;
+		memset(&addr, 0, sizeof addr);
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons((uint16_t)port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		int on = 1;
+		setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof on);
+		ok = ::bind(listener, (sockaddr*)&addr, sizeof addr) == 0;
+	}
+	else if (ok) {
+		sockaddr_un addr;
+		memset(&addr, 0, sizeof addr);
+		addr.sun_family = AF_UNIX;
+		ok = path.size() < sizeof addr.sun_path;
+		if (ok) {
+			strcpy(addr.sun_path, path.c_str());
+			unlink(path.c_str());
+			ok = ::bind(listener, (sockaddr*)&addr, sizeof addr) == 0;
+		}
+	}
+	if (ok && listen(listener, SOMAXCONN) == 0) return listener;
+	cerr << "cannot listen on " << listen_name(path, port) << endl;
+	if (listener >= 0) close(listener);
+	return -1;
+}
+//  ϳ а  Ʈ .    in, out   δ.
+struct fd_buf : streambuf {
+	int fd;
+	char ibuf[4096], obuf[4096];
+
+	fd_buf(int fd) : fd(fd) {
+		setg(ibuf, ibuf, ibuf);
+		setp(obuf, obuf + sizeof obuf);
+	}
+	~fd_buf() { sync(); }
+	int underflow() {
+		ssize_t n;
+		do n = ::read(fd, ibuf, sizeof ibuf); while (n < 0 && errno == EINTR);
+		if (n <= 0) return traits_type::eof();
+		setg(ibuf, ibuf, ibuf + n);
+		return traits_type::to_int_type(ibuf[0]);
+	}
+	int overflow(int c) {
+		if (sync() < 0) return traits_type::eof();
+		if (c != traits_type::eof()) {
+			*pptr() = (char)c;
+			pbump(1);
+		}
+		return traits_type::not_eof(c);
+	}
+	int sync() {
+		for (char* p = pbase(); p < pptr();) {
+			ssize_t n = ::write(fd, p, pptr() - p);
+			if (n < 0 && errno == EINTR) continue;
+			if (n <= 0) return -1;
+			p += n;
+		}
+		setp(obuf, obuf + sizeof obuf);
+		return 0;
+	}
+};
+//ϲ μ ϳ. Բ  Ͽ  ޾, Ḷ Է    ٿ   Ѵ.
+void serve_connections(interpreter& lisp, int listener) {
+	signal(SIGPIPE, SIG_IGN);//Ŭ̾Ʈ   ϲ  ֵ
+	while (true) {
+		int fd = accept(listener, 0, 0);
+		if (fd < 0) {
+			if (errno == EINTR) continue;
+			_exit(1);
+		}
+		{
+			fd_buf buf(fd);
+			istream conn_in(&buf);
+			ostream conn_out(&buf);
+			lisp.in = &conn_in;
+			lisp.out = &conn_out;
+			lisp.repl("");
+			lisp.in = &cin;
+			lisp.out = &cout;
+		}
+		close(fd);
+	}
+}
+pid_t fork_worker(interpreter& lisp, int listener) {
+	pid_t pid = fork();
+	if (pid == 0) {
+		serve_connections(lisp, listener);
+		_exit(0);
+	}
+	return pid;
+}
+//--workers N. ̸ о   ȯ ״ ޴ ϲ μ N ,
+//ϲ۵ path н  ϳ   ޴´. ϲ   .
+//fork ڿ θ ϲ   Բ ٰ,  ̵     ȴ.
+int serve_forked(interpreter& lisp, int workers, const string& path, int port) {
+	int listener = listen_on(path, port);
+	if (listener < 0) return 1;
+	lisp.collect(true);//  ⸦  ʴ´.
+	lisp.heap.finish_sweep();// ϲ malloc   ä fork ʵ ٸ.
+	cout << "listening on " << listen_name(path, port) << " with " << workers << " workers" << endl;
+	for (int i = 0; i < workers; i++) fork_worker(lisp, listener);
+	int status;
+	while (wait(&status) > 0)
+		if (WIFSIGNALED(status)) fork_worker(lisp, listener);
+	return 0;
+}
+#ifdef EPOLL_SERVER
+//--serve.  ϳ epoll   а ,  ͸ ϳ    Ѵ.
+//     ϳ ̹Ƿ,  Ŭ̾Ʈ   ʴ   ȯ濡 ǰ
+//䵵  ʷ .  ĸ   ̰, ϸ   ޽   տ ٴ´.
+const size_t SERVE_MAX_PENDING = 1024;// ٸ  ̸ŭ ̸  ῡ   ʴ´.
+const size_t SERVE_MAX_OUT = 1 << 20;//   ̸ŭ ׿   ʴ´.
+
+// Ʈ ֻ S ϳ ߶ . ȣ ڿ  ٹٲ   ʴ´.
+struct sexp_framer {
+	string buf;
+	size_t start, pos;//    ,   
+	int depth;
+	bool in_string, in_atom;
+
+	sexp_framer() : start(0), pos(0), depth(0), in_string(false), in_atom(false) {}
+	void feed(const char* p, size_t n) { buf.append(p, n); }
+	bool next(string& form) {
+		for (; pos < buf.size(); pos++) {
+			char ch = buf[pos];
+			bool space = ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t';
+			if (in_string) {
+				if (ch != '\"') continue;
+				in_string = false;
+				if (depth == 0) return cut(pos + 1, form);
+			}
+			else if (depth == 0 && in_atom && (space || ch == '(' || ch == '\"')) return cut(pos, form);
+			else if (ch == '\"') in_string = true;
+			else if (ch == '(') depth++;
+			else if (ch == ')') {
+				if (depth == 0) start = pos + 1;//¦  ݴ ȣ .
+				else if (--depth == 0) return cut(pos + 1, form);
+			}
+			else if (space) {
+				if (depth == 0 && start == pos) start = pos + 1;
+			}
+			else if (depth == 0 && !strchr("'`,@#", ch)) in_atom = true;
+		}
+		return false;
+	}
+	//Է   ٹٲ    ϳ
+	bool rest(string& form) { return in_atom && depth == 0 && cut(buf.size(), form); }
+
+private:
+	bool cut(size_t end, string& form) {
+		form.assign(buf, start, end - start);
+		replace_if(form.begin(), form.end(), [](char c) { return c == '\n' || c == '\r' || c == '\t'; }, ' ');//tokenize 鸸 ڷ .
+		start = pos = end;
+		in_atom = false;
+		if (start == buf.size()) {
+			buf.clear();
+			start = pos = 0;
+		}
+		else if (start > 65536) {
+			buf.erase(0, start);
+			pos -= start;
+			start = 0;
+		}
+		return true;
+	}
+};
+struct serve_job {
+	uint64_t conn;
+	string form;
+};
+//  ϳ. ڱ ͷ jobs ʷ Ѵ.
+struct serve_worker {
+	istringstream no_input;// ȣ  ä Ƿ tokenize    .
+	interpreter lisp;
+	mutex lock;
+	condition_variable ready;
+	vector<serve_job> jobs;
+
+	serve_worker() : lisp(no_input, cout) {}
+};
+struct serve_conn {
+	int fd;
+	size_t worker;
+	sexp_framer framer;
+	string out;//   
+	size_t pending;// ð     
+	bool eof;
+	uint32_t events;//epoll ɾ  
+
+	serve_conn() : fd(-1), worker(0), pending(0), eof(false), events(0) {}
+	bool reading() const { return !eof && pending < SERVE_MAX_PENDING && out.size() < SERVE_MAX_OUT; }
+};
+class eval_server {
+public:
+	eval_server(int listener, size_t interpreters, const vector<string>& files);
+	void run();
+
+private:
+	enum { LISTENER = 0, WAKE = 1 };//epoll_event.data.u64.  2 ȣ δ.
+	int listener, ep, wake_fd;
+	vector<unique_ptr<serve_worker> > workers;
+	unordered_map<uint64_t, serve_conn> conns;
+	uint64_t next_id;
+	size_t next_worker;
+	vector<uint64_t> dirty;//̹ ʿ    
+	mutex done_lock;
+	vector<pair<uint64_t, string> > done;// 尡  
+
+	void compute(serve_worker* w);
+	void post(uint64_t conn, const string& text);
+	void accept_all();
+	void read_conn(uint64_t id, serve_conn& c);
+	void deliver();
+	void flush(uint64_t id);
+	void watch(uint64_t id, serve_conn& c);
+	void close_conn(uint64_t id);
+};
+eval_server::eval_server(int listener, size_t interpreters, const vector<string>& files)
+	: listener(listener), ep(epoll_create1(EPOLL_CLOEXEC)), wake_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)), next_id(2), next_worker(0) {
+	fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+	epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.u64 = LISTENER;
+	epoll_ctl(ep, EPOLL_CTL_ADD, listener, &ev);
+	ev.data.u64 = WAKE;
+	epoll_ctl(ep, EPOLL_CTL_ADD, wake_fd, &ev);
+	for (size_t i = 0; i < max(interpreters, (size_t)1); i++) {
+		workers.push_back(unique_ptr<serve_worker>(new serve_worker));
+		for (size_t k = 0; k < files.size(); k++)
+			if (!workers[i]->lisp.load(files[k]) && i == 0) cerr << "cannot open " << files[k] << endl;
+	}
+	for (size_t i = 0; i < workers.size(); i++) thread(&eval_server::compute, this, workers[i].get()).detach();
+}
+void eval_server::compute(serve_worker* w) {
+	vector<serve_job> batch;
+	while (true) {
+		{
+			unique_lock<mutex> guard(w->lock);
+			w->ready.wait(guard, [w] { return !w->jobs.empty(); });
+			batch.swap(w->jobs);
+		}
+		for (size_t i = 0; i < batch.size(); i++) {
+			ostringstream out;
+			w->lisp.out = &out;
+			cell result = w->lisp.eval_line(batch[i].form);
+			out << to_string(result) << '\n';
+			post(batch[i].conn, out.str());
+			w->lisp.collect(false);
+		}
+		batch.clear();
+	}
+}
+// ѱ. ̺Ʈ       ̹ Ƿ ٽ  ʴ´.
+void eval_server::post(uint64_t conn, const string& text) {
+	bool first;
+	{
+		lock_guard<mutex> guard(done_lock);
+		first = done.empty();
+		done.push_back(make_pair(conn, text));
+	}
+	uint64_t one = 1;
+	if (first && ::write(wake_fd, &one, sizeof one) < 0) {}
+}
+void eval_server::run() {
+	epoll_event events[256];
+	while (true) {
+		int n = epoll_wait(ep, events, 256, -1);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			return;
+		}
+		for (int i = 0; i < n; i++) {
+			uint64_t id = events[i].data.u64;
+			if (id == LISTENER) accept_all();
+			else if (id == WAKE) {
+				uint64_t count;
+				if (::read(wake_fd, &count, sizeof count) < 0) {}
+				deliver();
+			}
+			else {
+				unordered_map<uint64_t, serve_conn>::iterator c = conns.find(id);
+				if (c == conns.end()) continue;
+				if (events[i].events & (EPOLLHUP | EPOLLERR)) close_conn(id);//    䵵 .
+				else {
+					if (events[i].events & EPOLLIN) read_conn(id, c->second);
+					if (events[i].events & EPOLLOUT) flush(id);
+				}
+			}
+		}
+		//̹ ʿ   Ḷ write   .
+		for (size_t i = 0; i < dirty.size(); i++) flush(dirty[i]);
+		dirty.clear();
+	}
+}
+void eval_server::accept_all() {
+	while (true) {
+		int fd = accept4(listener, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) {
+			if (errno == EINTR) continue;
+			return;
+		}
+		int on = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof on);//   Ƿ Nagle ʿ . н Ͽ ص ȴ.
+		uint64_t id = next_id++;
+		serve_conn& c = conns[id];
+		c.fd = fd;
+		c.worker = next_worker++ % workers.size();
+		c.events = EPOLLIN;
+		epoll_event ev;
+		ev.events = c.events;
+		ev.data.u64 = id;
+		epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+	}
+}
+//  ִ ŭ а,  ĵ Ѳ    忡 ñ.
+void eval_server::read_conn(uint64_t id, serve_conn& c) {
+	char buf[65536];
+	while (true) {
+		ssize_t n = ::read(c.fd, buf, sizeof buf);
+		if (n > 0) {
+			c.framer.feed(buf, n);
+			if ((size_t)n < sizeof buf) break;
+		}
+		else if (n == 0) {
+			c.eof = true;
+			break;
+		}
+		else if (errno == EINTR) continue;
+		else if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+		else {
+			close_conn(id);
+			return;
+		}
+	}
+	vector<serve_job> jobs;
+	string form;
+	while (c.framer.next(form)) jobs.push_back(serve_job{ id, form });
+	if (c.eof && c.framer.rest(form)) jobs.push_back(serve_job{ id, form });
+	if (!jobs.empty()) {
+		serve_worker& w = *workers[c.worker];
+		c.pending += jobs.size();
+		{
+			lock_guard<mutex> guard(w.lock);
+			w.jobs.insert(w.jobs.end(), jobs.begin(), jobs.end());
+		}
+		w.ready.notify_one();
+	}
+	if (c.eof && c.pending == 0 && c.out.empty()) close_conn(id);
+	else watch(id, c);
+}
+void eval_server::deliver() {
+	vector<pair<uint64_t, string> > batch;
+	{
+		lock_guard<mutex> guard(done_lock);
+		batch.swap(done);
+	}
+	for (size_t i = 0; i < batch.size(); i++) {
+		unordered_map<uint64_t, serve_conn>::iterator c = conns.find(batch[i].first);
+		if (c == conns.end()) continue;//̹  
+		if (c->second.out.empty()) dirty.push_back(c->first);
+		c->second.out += batch[i].second;
+		c->second.pending--;
+	}
+}
+// ʴ ŭ ,  EPOLLOUT ٸ.
+void eval_server::flush(uint64_t id) {
+	unordered_map<uint64_t, serve_conn>::iterator it = conns.find(id);
+	if (it == conns.end()) return;
+	serve_conn& c = it->second;
+	size_t sent = 0;
+	while (sent < c.out.size()) {
+		ssize_t n = ::send(c.fd, c.out.data() + sent, c.out.size() - sent, MSG_NOSIGNAL);
+		if (n > 0) sent += n;
+		else if (n < 0 && errno == EINTR) continue;
+		else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+		else {
+			close_conn(id);
+			return;
+		}
+	}
+	c.out.erase(0, sent);
+	if (c.eof && c.pending == 0 && c.out.empty()) close_conn(id);
+	else watch(id, c);
+}
+void eval_server::watch(uint64_t id, serve_conn& c) {
+	uint32_t want = (c.reading() ? (uint32_t)EPOLLIN : (uint32_t)0) | (c.out.empty() ? (uint32_t)0 : (uint32_t)EPOLLOUT);
+	if (want == c.events) return;
+	epoll_event ev;
+	ev.events = want;
+	ev.data.u64 = id;
+	epoll_ctl(ep, EPOLL_CTL_MOD, c.fd, &ev);
+	c.events = want;
+}
+// 忡   ״ ǰ,  deliver .
+void eval_server::close_conn(uint64_t id) {
+	unordered_map<uint64_t, serve_conn>::iterator c = conns.find(id);
+	epoll_ctl(ep, EPOLL_CTL_DEL, c->second.fd, 0);
+	close(c->second.fd);
+	conns.erase(c);
 }
+int serve_epoll(const vector<string>& files, size_t interpreters, const string& path, int port) {
+	int listener = listen_on(path, port);
+	if (listener < 0) return 1;
+	signal(SIGPIPE, SIG_IGN);
+	eval_server server(listener, interpreters, files);
+	cout << "serving on " << listen_name(path, port) << " with " << max(interpreters, (size_t)1) << " interpreters" << endl;
+	server.run();
+	return 1;
+}
+#endif
+#endif
 
-int main()
+//mylisp [...] [--serve] [--workers N] [--socket  | --port ȣ]
+//ϵ   , --serve  μ   N, --workers  ϲ μ N
+//  ް,    REPL Ѵ.
+int main(int argc, char* argv[])
 {
-	environment global_env;
-	add_globals(global_env);
-	repl("90> ", &global_env);
+	vector<string> files;
+	int workers = 0, port = 0;
+	bool serve = false;
+	string path = "mylisp.sock";
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--workers" && i + 1 < argc) workers = atoi(argv[++i]);
+		else if (arg == "--socket" && i + 1 < argc) path = argv[++i];
+		else if (arg == "--port" && i + 1 < argc) port = atoi(argv[++i]);
+		else if (arg == "--serve") serve = true;
+		else files.push_back(arg);
+	}
+#ifdef EPOLL_SERVER
+	if (serve) return serve_epoll(files, workers > 0 ? workers : thread::hardware_concurrency(), path, port);
+#else
+	if (serve) cerr << "--serve is only supported on Linux" << endl;
+#endif
+	interpreter lisp;
+	for (size_t i = 0; i < files.size(); i++)
+		if (!lisp.load(files[i])) cerr << "cannot open " << files[i] << endl;
+#ifndef _WIN32
+	if (workers > 0) return serve_forked(lisp, workers, path, port);
+#else
+	if (workers > 0) cerr << "--workers is not supported on Windows" << endl;
+#endif
+	lisp.repl("90> ");
 
 }
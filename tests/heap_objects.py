@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+# 힙 객체(해시 테이블, 숫자 벡터, 행렬)를 바꾼 뒤 GC를 해도 값이 남아 있는지, 빈 입력에 죽지 않는지 본다.
+# EQ 집합 연산이 16개 앞뒤에서 같은 답을 내는지는 tests/set_ops_eq.py가 본다.
+#	python3 tests/heap_objects.py 실행파일
+import subprocess, sys
+
+CASES = [
+    # CLRHASH는 테이블을 제자리에서 비워야 GC가 그 테이블을 계속 안다.
+    ("(SETQ H (MAKE-HASH-TABLE))", None),
+    ("(SETHASH 1 H 2)", "2"),
+    ("(CLRHASH H)", None),
+    ("(SETHASH 3 H 4)", "4"),
+    ("(GC)", None),
+    ("(GETHASH 3 H)", "4"),
+    ("(GETHASH 1 H)", "NIL"),
+    # 숫자 하나를 벡터, 행렬에 맞춰 늘려 계산한 결과는 GC 뒤에도 남는다.
+    ("(SETQ V (V+ 1 (VECTOR 1 2 3)))", "#(2 3 4)"),
+    ("(SETQ W (V* (VECTOR 1 2) 2))", "#(2 4)"),
+    ("(SETQ M (V+ 10 (MATRIX '((1 2) (3 4)))))", "#2A((11 12) (13 14))"),
+    ("(GC)", None),
+    ("V", "#(2 3 4)"),
+    ("W", "#(2 4)"),
+    ("M", "#2A((11 12) (13 14))"),
+    # 빈 입력은 0으로 나누지 않고 답하거나 ERROR를 낸다.
+    ("(TRANSPOSE (VECTOR))", "#()"),
+    ("(MATMUL (VECTOR) (VECTOR))", "ERROR"),
+    ("(SOLVE (VECTOR) (VECTOR))", "ERROR"),
+    ("(+ 1 2)", "3"),
+]
+
+def main():
+    binary = sys.argv[1] if len(sys.argv) > 1 else './mylisp'
+    forms = [form for form, _ in CASES]
+    run = subprocess.run([binary], input='\n'.join(forms) + '\n', capture_output=True, text=True, timeout=60)
+    replies = [r.strip() for r in run.stdout.split('90> ')[1:]][:len(forms)]
+    if run.returncode != 0 or len(replies) != len(forms):
+        print('FAIL: exit code %d after %d of %d forms' % (run.returncode, len(replies), len(forms)))
+        return 1
+    failed = False
+    for (form, expected), reply in zip(CASES, replies):
+        if expected is not None and reply != expected:
+            print('FAIL:', form, '->', reply, '(expected %s)' % expected)
+            failed = True
+    if failed:
+        return 1
+    print('ok')
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+# --serve 서버에 잘못된 식을 보낸 뒤에도 서버가 살아서 다른 클라이언트에 답하는지 본다.
+#	python3 tests/serve_malformed.py 실행파일
+import os, socket, subprocess, sys, tempfile, time
+
+MALFORMED = [
+    '(CAR)', '(CDR)', '(CONS 1)', '(LENGTH)', '(MEMBER 1)', '(SUBST 1 2)',
+    '(/ \'A)', '(+ 1.5 \'A)', '(< 1 \'A)', '(= \'A)',
+    '(IF 1)', '(SETQ 1)', '(COND 1)', '(DO \'A \'B \'C)', '(NTH -1 \'(1 2))',
+    '(TIME)', '(FUTURE)', '(DELAY)', '(TAKE 3)', '(LAZY-MAP 1)',
+    '(OMAP-NEXT)', '(VREF #(1 2) 100)', '(MAKE-VECTOR 100000000000000)',
+    '(DEFUN G (N) (+ 1 (G N)))', '(G 1)', '(JOIN (SPAWN (G 1)))',
+]
+
+def talk(path, text):
+    s = socket.socket(socket.AF_UNIX)
+    s.connect(path)
+    s.sendall(text.encode())
+    s.shutdown(socket.SHUT_WR)
+    data = b''
+    while True:
+        chunk = s.recv(65536)
+        if not chunk:
+            break
+        data += chunk
+    s.close()
+    return data.decode(errors='replace')
+
+def main():
+    binary = sys.argv[1] if len(sys.argv) > 1 else './mylisp'
+    path = os.path.join(tempfile.mkdtemp(), 'serve.sock')
+    server = subprocess.Popen([binary, '--serve', '--workers', '1', '--socket', path],
+                              stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    try:
+        for _ in range(100):
+            if os.path.exists(path):
+                break
+            time.sleep(0.05)
+        for form in MALFORMED:
+            try:
+                talk(path, form + '\n')
+            except OSError:
+                time.sleep(0.2)
+            if server.poll() is not None:
+                print('FAIL: server died on', form)
+                return 1
+        reply = talk(path, '\n'.join(MALFORMED) + '\n(+ 1 2)\n')
+        if not reply.endswith('3\n'):
+            print('FAIL: no answer after malformed forms in one connection:', repr(reply[-200:]))
+            return 1
+        reply = talk(path, '(+ 1 2)\n')
+        if reply != '3\n':
+            print('FAIL: second client got', repr(reply))
+            return 1
+        print('ok')
+        return 0
+    finally:
+        server.kill()
+        server.wait()
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+# 집합 연산의 답이 찾을 리스트의 길이(SET_HASH_MIN = 16 앞뒤)에 따라 달라지지 않는지 본다.
+# 16개 이상이면 해시 테이블로 찾는데, 해시 테이블은 EQL/EQUAL로만 비교하므로 :TEST #'EQ는 훑어서 찾아야 한다.
+#	python3 tests/set_ops_eq.py 실행파일
+import subprocess, sys
+
+def evaluate(binary, forms):
+    out = subprocess.run([binary], input='\n'.join(forms) + '\n', capture_output=True, text=True, timeout=60).stdout
+    replies = [r.strip() for r in out.split('90> ')[1:]]
+    return replies[:len(forms)]
+
+def padding(n):
+    return ' '.join(str(100 + i) for i in range(n))
+
+def main():
+    binary = sys.argv[1] if len(sys.argv) > 1 else './mylisp'
+    cases = []
+    for test in ["#'EQ", "#'EQL", "#'EQUAL"]:
+        for op in ['INTERSECTION', 'SET-DIFFERENCE', 'UNION']:
+            for n in [14, 15, 16, 17, 18]:
+                form = "(LENGTH (%s (LIST (+ 1 0.5) 7) (LIST 1.5 7 %s) :TEST %s))" % (op, padding(n - 2), test)
+                cases.append(((test, op), n, form))
+        for n in [14, 15, 16, 17, 18]:
+            form = "(LENGTH (REMOVE-DUPLICATES (LIST 1.5 (+ 1 0.5) 7 7 %s) :TEST %s))" % (padding(n - 4), test)
+            cases.append(((test, 'REMOVE-DUPLICATES'), n, form))
+    replies = evaluate(binary, [form for _, _, form in cases])
+    if len(replies) != len(cases):
+        print('FAIL: expected %d replies, got %d' % (len(cases), len(replies)))
+        return 1
+    answers = {}
+    for (key, n, form), reply in zip(cases, replies):
+        # 덧붙인 원소 수만큼을 빼서 길이와 상관없는 값으로 맞춘다.
+        extra = n - 2 if key[1] == 'UNION' else n - 4 if key[1] == 'REMOVE-DUPLICATES' else 0
+        if not reply.lstrip('-').isdigit():
+            print('FAIL:', form, '->', reply)
+            return 1
+        answers.setdefault(key, {})[n] = int(reply) - extra
+    failed = False
+    for key, by_length in sorted(answers.items()):
+        if len(set(by_length.values())) != 1:
+            print('FAIL: %s %s depends on the list length: %s' % (key[1], key[0], by_length))
+            failed = True
+    if failed:
+        return 1
+    print('ok')
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())